@@ -0,0 +1,506 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+/*
+ * linear_bench: timings of the kernels and solvers of the library.
+ *
+ *   linear_bench [--sizes 32,128,512] [--repeat 15] [--filter NAME] [--json FILE]
+ *                [--compare BASELINE] [--tolerance 0.1]
+ *
+ * Every case runs one method on one matrix family (random, spd, diag_dominant, graph) and size.
+ * A sample repeats the call until it takes at least a millisecond; the median and p95 over --repeat
+ * samples are reported, with GFLOP/s for methods of a known flop count and the iterations of iterative
+ * ones. --json writes the results ("-" for stdout); --compare reads such a file and flags every case
+ * whose median grew by more than --tolerance or whose iteration count grew, exiting with 1 if any did.
+ */
+
+#include "../methods/simple_iteration.hpp"
+#include "../methods/eigen_divide_conquer.hpp"
+#include "../methods/eigen_francis.hpp"
+#include "../methods/eigen_qr.hpp"
+#include "../methods/eigen_qr_shifts.hpp"
+#include "../methods/eigen_simple_iteration.hpp"
+#include "../methods/givens.hpp"
+#include "../methods/householder.hpp"
+#include "../methods/krylov.hpp"
+#include "../methods/lanczos.hpp"
+#include "../methods/lu.hpp"
+#include "../methods/seidel.hpp"
+#include "../methods/tridiagonalization.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Linear;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ * Matrix families. Generation is seeded by n, so every run benchmarks the same matrices.
+ */
+
+Matrix<double> random_matrix(int n, std::mt19937 &gen) {
+  std::uniform_real_distribution<double> dist(-1, 1);
+  Matrix<double> A(n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      A.at(i, j) = dist(gen);
+    }
+  }
+  return A;
+}
+
+Matrix<double> make_matrix(const std::string &family, int n) {
+  std::mt19937 gen(n);
+  if (family == "random") {
+    return random_matrix(n, gen);
+  }
+  if (family == "spd") {// B * B^T / n + I
+    auto B = random_matrix(n, gen);
+    Matrix<double> A = B * B.transpose();
+    A *= 1.0 / n;
+    for (int i = 0; i < n; i++) {
+      A.at(i, i) += 1;
+    }
+    return A;
+  }
+  if (family == "diag_dominant") {
+    auto A = random_matrix(n, gen);
+    for (int i = 0; i < n; i++) {
+      double sum = 0;
+      for (int j = 0; j < n; j++) {
+        sum += (i != j ? std::abs(A.at(i, j)) : 0);
+      }
+      A.at(i, i) = sum + 1;
+    }
+    return A;
+  }
+  if (family == "graph") {// adjacency of a cycle with about 4 random chords per vertex
+    Matrix<double> A(n);
+    std::uniform_int_distribution<int> vertex(0, n - 1);
+    for (int i = 0; i < n; i++) {
+      const int next = (i + 1) % n;
+      if (next != i) {
+        A.at(i, next) = A.at(next, i) = 1;
+      }
+      for (int k = 0; k < 2; k++) {
+        int j = vertex(gen);
+        if (j != i) {
+          A.at(i, j) = A.at(j, i) = 1;
+        }
+      }
+    }
+    return A;
+  }
+  throw std::runtime_error("Unknown matrix family!");
+}
+
+// A scaled so that every Gershgorin circle lies in the unit disc, for x = A * x + b.
+Matrix<double> contraction(Matrix<double> A) {
+  double norm = 0;
+  for (int i = 0; i < A.n; i++) {
+    double sum = 0;
+    for (int j = 0; j < A.n; j++) {
+      sum += std::abs(A.at(i, j));
+    }
+    norm = std::max(norm, sum);
+  }
+  A *= 0.9 / norm;
+  return A;
+}
+
+/*
+ * Cases
+ */
+
+struct Outcome {
+  int iterations = -1;// -1 for a direct method
+  bool converged = true;
+};
+
+struct Case {
+  std::string name;
+  std::vector<std::string> families;
+  int max_n;
+  // Flops of one call, 0 if not known in closed form.
+  std::function<double(double n, const Outcome &)> flops;
+  // Prepares the inputs outside of the timed region and returns the timed call.
+  std::function<std::function<Outcome()>(const Matrix<double> &)> prepare;
+};
+
+template<typename F>
+std::function<std::function<Outcome()>(const Matrix<double> &)> direct(F f) {
+  return [f](const Matrix<double> &A) {
+    auto M = std::make_shared<Matrix<double>>(A);
+    return std::function<Outcome()>([f, M] {
+      f(*M);
+      return Outcome();
+    });
+  };
+}
+
+std::function<std::function<Outcome()>(const Matrix<double> &)> krylov_like(
+    std::function<std::optional<std::vector<double>>(const Matrix<double> &, const std::vector<double> &, SolverReport *)> solve) {
+  return [solve](const Matrix<double> &A) {
+    auto M = std::make_shared<Matrix<double>>(A);
+    auto b = std::make_shared<std::vector<double>>(A.n, 1.0);
+    return std::function<Outcome()>([solve, M, b] {
+      SolverReport report;
+      bool ok = solve(*M, *b, &report).has_value();
+      return Outcome{report.iterations, ok};
+    });
+  };
+}
+
+double per_iteration(double n, const Outcome &o) {
+  return 2 * n * n * std::max(o.iterations, 0);
+}
+
+std::vector<Case> cases() {
+  const double EPS = 1e-8;
+  std::vector<std::string> all = {"random", "spd", "diag_dominant", "graph"};
+  return {
+      {"gemm", {"random"}, 1 << 30, [](double n, const Outcome &) { return 2 * n * n * n; },
+       [](const Matrix<double> &A) {
+         auto M = std::make_shared<Matrix<double>>(A);
+         auto C = std::make_shared<Matrix<double>>(A.n);
+         return std::function<Outcome()>([M, C] {
+           gemm(M->n, M->n, M->n, 1.0, M->data(), M->ld, M->data(), M->ld, 0.0, C->data(), C->ld);
+           return Outcome();
+         });
+       }},
+      {"matvec", {"random"}, 1 << 30, [](double n, const Outcome &) { return 2 * n * n; },
+       [](const Matrix<double> &A) {
+         auto M = std::make_shared<Matrix<double>>(A);
+         auto x = std::make_shared<std::vector<double>>(A.n, 1.0), y = std::make_shared<std::vector<double>>(A.n);
+         return std::function<Outcome()>([M, x, y] {
+           M->matvec(x->data(), y->data());
+           return Outcome();
+         });
+       }},
+      {"QR_givens", {"random"}, 1 << 30, [](double n, const Outcome &) { return 2 * n * n * n; },
+       direct([](const Matrix<double> &A) { QR_givens(A); })},
+      {"QR_householder", {"random"}, 1 << 30, [](double n, const Outcome &) { return 8 * n * n * n / 3; },
+       direct([](const Matrix<double> &A) { QR_householder(A); })},
+      {"tridiagonalization", {"spd", "graph"}, 1 << 30, [](double n, const Outcome &) { return 8 * n * n * n / 3; },
+       direct([](const Matrix<double> &A) { tridiagonalization(A); })},
+      {"LU_blocked", {"random", "diag_dominant"}, 1 << 30, [](double n, const Outcome &) { return 2 * n * n * n / 3; },
+       direct([](const Matrix<double> &A) { LU_blocked(A); })},
+      {"mixed_precision_solve", {"spd", "diag_dominant"}, 1 << 30, [](double n, const Outcome &) { return 2 * n * n * n / 3; },
+       krylov_like([](const Matrix<double> &A, const std::vector<double> &b, SolverReport *r) {
+         return std::optional(mixed_precision_solve(A, b, r));
+       })},
+      // unshifted, up to LIMIT O(n^3) steps: small sizes only; the repeats share a workspace
+      {"eigen_qr", {"spd"}, 32, [](double, const Outcome &) { return 0.0; },
+       [](const Matrix<double> &A) {
+         auto M = std::make_shared<Matrix<double>>(A);
+         auto workspace = std::make_shared<Workspace>();
+         return std::function<Outcome()>([M, workspace] {
+           SolverReport report;
+           bool ok = eigen_qr(*M, 1e-3, &report, nullptr, workspace.get()).has_value();
+           return Outcome{report.iterations, ok};
+         });
+       }},
+      {"eigen_qr_shift", {"spd", "graph"}, 1 << 30, [](double, const Outcome &) { return 0.0; },
+       [EPS](const Matrix<double> &A) {
+         auto T = std::make_shared<SymTridiagonal<double>>(tridiagonal_reduction(A).tridiagonal());
+         return std::function<Outcome()>([T, EPS] {
+           SolverReport report;
+           bool ok = eigen_qr_shift(*T, false, EPS, &report).has_value();
+           return Outcome{report.iterations, ok};
+         });
+       }},
+      {"eigen_divide_conquer", {"spd", "graph"}, 1 << 30, [](double, const Outcome &) { return 0.0; },
+       [](const Matrix<double> &A) {
+         auto T = std::make_shared<SymTridiagonal<double>>(tridiagonal_reduction(A).tridiagonal());
+         return std::function<Outcome()>([T] { return Outcome{-1, eigen_divide_conquer(*T).has_value()}; });
+       }},
+      {"eigen_francis", {"random", "spd"}, 1 << 30, [](double, const Outcome &) { return 0.0; },
+       [EPS](const Matrix<double> &A) {
+         auto M = std::make_shared<Matrix<double>>(A);
+         return std::function<Outcome()>([M, EPS] {
+           SolverReport report;
+           bool ok = eigen_francis(*M, EPS, &report).has_value();
+           return Outcome{report.iterations, ok};
+         });
+       }},
+      {"lanczos", {"spd", "graph"}, 1 << 30, [](double, const Outcome &) { return 0.0; },
+       [](const Matrix<double> &A) {
+         auto M = std::make_shared<Matrix<double>>(A);
+         return std::function<Outcome()>([M] { return Outcome{-1, lanczos(*M, 3, Spectrum::both_ends).has_value()}; });
+       }},
+      {"simple_iteration", all, 1 << 30, per_iteration,
+       [EPS](const Matrix<double> &A) {
+         auto M = std::make_shared<Matrix<double>>(contraction(A));
+         auto b = std::make_shared<std::vector<double>>(A.n, 1.0);
+         return std::function<Outcome()>([M, b, EPS] {
+           SolverReport report;
+           bool ok = simple_iteration(*M, *b, EPS, &report).has_value();
+           return Outcome{report.iterations, ok};
+         });
+       }},
+      {"eigen_simple_iteration", {"spd"}, 1 << 30, per_iteration,
+       [](const Matrix<double> &A) {
+         auto M = std::make_shared<Matrix<double>>(A);
+         return std::function<Outcome()>([M] {
+           SolverReport report;
+           bool ok = eigen_simple_iteration(*M, 1e-6, &report).has_value();
+           return Outcome{report.iterations, ok};
+         });
+       }},
+      {"seidel", {"diag_dominant", "spd"}, 1 << 30, per_iteration,
+       krylov_like([EPS](const Matrix<double> &A, const std::vector<double> &b, SolverReport *r) { return seidel(A, b, EPS, r); })},
+      {"sor", {"diag_dominant", "spd"}, 1 << 30, per_iteration,
+       krylov_like([EPS](const Matrix<double> &A, const std::vector<double> &b, SolverReport *r) { return sor(A, b, AUTO_OMEGA, EPS, r); })},
+      {"multicolor_sor", {"diag_dominant"}, 1 << 30, per_iteration,
+       krylov_like([EPS](const Matrix<double> &A, const std::vector<double> &b, SolverReport *r) {
+         return multicolor_sor(A, b, AUTO_OMEGA, EPS, r);
+       })},
+      {"jacobi", {"diag_dominant"}, 1 << 30, per_iteration,
+       krylov_like([EPS](const Matrix<double> &A, const std::vector<double> &b, SolverReport *r) { return jacobi(A, b, 1, EPS, r); })},
+      {"cg", {"spd"}, 1 << 30, per_iteration,
+       krylov_like([EPS](const Matrix<double> &A, const std::vector<double> &b, SolverReport *r) { return cg(A, b, EPS, r); })},
+      {"gmres", {"diag_dominant", "spd"}, 1 << 30, per_iteration,
+       krylov_like([EPS](const Matrix<double> &A, const std::vector<double> &b, SolverReport *r) { return gmres(A, b, 30, EPS, r); })},
+  };
+}
+
+/*
+ * Measurement
+ */
+
+struct Result {
+  std::string name, family;
+  int n = 0;
+  double median_ms = 0, p95_ms = 0, gflops = 0;
+  Outcome outcome;
+
+  std::string key() const {
+    return name + "/" + family + "/" + std::to_string(n);
+  }
+};
+
+Result measure(const Case &c, const std::string &family, int n, int repeat) {
+  auto run = c.prepare(make_matrix(family, n));
+  Outcome outcome = run();// warm-up: caches, the thread pool, the GEMM buffers
+
+  auto t0 = Clock::now();
+  run();
+  const double once = std::chrono::duration<double>(Clock::now() - t0).count();
+  const int inner = std::max(1, std::min(1000, int(1e-3 / std::max(once, 1e-9))));
+
+  std::vector<double> samples;
+  for (int r = 0; r < repeat; r++) {
+    auto start = Clock::now();
+    for (int k = 0; k < inner; k++) {
+      outcome = run();
+    }
+    samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count() / inner);
+  }
+  std::sort(samples.begin(), samples.end());
+
+  Result res;
+  res.name = c.name;
+  res.family = family;
+  res.n = n;
+  res.median_ms = samples[samples.size() / 2];
+  res.p95_ms = samples[std::min(samples.size() - 1, size_t(0.95 * samples.size()))];
+  res.outcome = outcome;
+  res.gflops = c.flops(n, outcome) / (res.median_ms * 1e6);
+  return res;
+}
+
+/*
+ * JSON, one result per line, so that --compare reads it back without a JSON library
+ */
+
+void write_json(std::ostream &out, const std::vector<Result> &results) {
+  out << "{\n  \"threads\": " << thread_pool().size() << ",\n  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto &r = results[i];
+    out << "    {\"name\": \"" << r.name << "\", \"family\": \"" << r.family << "\", \"n\": " << r.n
+        << ", \"median_ms\": " << r.median_ms << ", \"p95_ms\": " << r.p95_ms << ", \"gflops\": ";
+    if (r.gflops > 0) {
+      out << r.gflops;
+    } else {
+      out << "null";
+    }
+    out << ", \"iterations\": ";
+    if (r.outcome.iterations >= 0) {
+      out << r.outcome.iterations;
+    } else {
+      out << "null";
+    }
+    out << ", \"converged\": " << (r.outcome.converged ? "true" : "false") << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+// Value of "key": in a line written by write_json, without quotes; empty if absent.
+std::string json_field(const std::string &line, const std::string &key) {
+  auto pos = line.find("\"" + key + "\": ");
+  if (pos == std::string::npos) {
+    return "";
+  }
+  pos += key.size() + 4;
+  if (line[pos] == '"') {
+    return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+  }
+  return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+std::map<std::string, Result> read_json(const std::string &path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Cannot open baseline!");
+  }
+  std::map<std::string, Result> res;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (json_field(line, "name").empty()) {
+      continue;
+    }
+    Result r;
+    r.name = json_field(line, "name");
+    r.family = json_field(line, "family");
+    r.n = std::stoi(json_field(line, "n"));
+    r.median_ms = std::stod(json_field(line, "median_ms"));
+    auto iterations = json_field(line, "iterations");
+    r.outcome.iterations = (iterations == "null" ? -1 : std::stoi(iterations));
+    res[r.key()] = r;
+  }
+  return res;
+}
+
+// Prints the cases that got slower (or needed more iterations) or faster; returns the number of regressions.
+int compare(FILE *out, const std::vector<Result> &results, const std::map<std::string, Result> &baseline, double tolerance) {
+  int regressions = 0;
+  fprintf(out, "\n%-24s %-14s %6s %12s %12s %8s  %s\n", "method", "family", "n", "base ms", "ms", "ratio", "");
+  for (const auto &r : results) {
+    auto it = baseline.find(r.key());
+    if (it == baseline.end()) {
+      fprintf(out, "%-24s %-14s %6d %12s %12.4f %8s  new\n", r.name.c_str(), r.family.c_str(), r.n, "-", r.median_ms, "-");
+      continue;
+    }
+    const Result &base = it->second;
+    const double ratio = r.median_ms / base.median_ms;
+    std::string verdict;
+    if (ratio > 1 + tolerance) {
+      verdict = "REGRESSION";
+    } else if (ratio < 1 - tolerance) {
+      verdict = "faster";
+    }
+    if (base.outcome.iterations >= 0 && r.outcome.iterations > base.outcome.iterations) {
+      verdict = "REGRESSION (iterations " + std::to_string(base.outcome.iterations) + " -> " + std::to_string(r.outcome.iterations) + ")";
+    }
+    regressions += (verdict.rfind("REGRESSION", 0) == 0);
+    fprintf(out, "%-24s %-14s %6d %12.4f %12.4f %8.3f  %s\n", r.name.c_str(), r.family.c_str(), r.n, base.median_ms, r.median_ms, ratio, verdict.c_str());
+  }
+  fprintf(out, "\n%d regression(s) beyond %.0f%%\n", regressions, 100 * tolerance);
+  return regressions;
+}
+
+std::vector<int> parse_sizes(const std::string &s) {
+  std::vector<int> res;
+  std::stringstream in(s);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    res.push_back(std::stoi(item));
+  }
+  return res;
+}
+
+// "-" for a missing value.
+std::string format(double x, bool present) {
+  if (!present) {
+    return "-";
+  }
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.3f", x);
+  return buf;
+}
+
+int usage() {
+  fprintf(stderr, "usage: linear_bench [--sizes 32,128,512] [--repeat 15] [--filter NAME] [--json FILE]\n"
+                  "                    [--compare BASELINE] [--tolerance 0.1]\n");
+  return 2;
+}
+
+}// namespace
+
+int main(int argc, char **argv) {
+  std::vector<int> sizes = {32, 128, 512};
+  int repeat = 15;
+  std::string filter, json, baseline;
+  double tolerance = 0.1;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (i + 1 == argc) {
+      return usage();
+    }
+    std::string value = argv[++i];
+    if (arg == "--sizes") {
+      sizes = parse_sizes(value);
+    } else if (arg == "--repeat") {
+      repeat = std::max(1, std::stoi(value));
+    } else if (arg == "--filter") {
+      filter = value;
+    } else if (arg == "--json") {
+      json = value;
+    } else if (arg == "--compare") {
+      baseline = value;
+    } else if (arg == "--tolerance") {
+      tolerance = std::stod(value);
+    } else {
+      return usage();
+    }
+  }
+
+  // the table goes to stderr when stdout carries the JSON
+  FILE *table = (json == "-" ? stderr : stdout);
+  std::vector<Result> results;
+  fprintf(table, "%-24s %-14s %6s %12s %12s %9s %10s\n", "method", "family", "n", "median ms", "p95 ms", "GFLOP/s", "iterations");
+  for (const auto &c : cases()) {
+    if (!filter.empty() && c.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    for (const auto &family : c.families) {
+      for (int n : sizes) {
+        if (n > c.max_n) {
+          continue;
+        }
+        auto r = measure(c, family, n, repeat);
+        fprintf(table, "%-24s %-14s %6d %12.4f %12.4f %9s %10s%s\n", r.name.c_str(), r.family.c_str(), r.n, r.median_ms, r.p95_ms,
+               format(r.gflops, r.gflops > 0).c_str(), r.outcome.iterations >= 0 ? std::to_string(r.outcome.iterations).c_str() : "-",
+               r.outcome.converged ? "" : "  (did not converge)");
+        fflush(table);
+        results.push_back(r);
+      }
+    }
+  }
+
+  if (json == "-") {
+    write_json(std::cout, results);
+  } else if (!json.empty()) {
+    std::ofstream out(json);
+    write_json(out, results);
+  }
+  if (!baseline.empty()) {
+    return compare(table, results, read_json(baseline), tolerance) > 0 ? 1 : 0;
+  }
+  return 0;
+}
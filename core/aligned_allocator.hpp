@@ -0,0 +1,55 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_ALIGNED_ALLOCATOR_HPP_
+#define LINEAR_CORE_ALIGNED_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <new>
+
+namespace Linear {
+
+const std::size_t CACHE_LINE = 64;
+
+template<typename T, std::size_t Alignment = CACHE_LINE>
+struct AlignedAllocator {
+  using value_type = T;
+
+  template<typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {
+  }
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+  void deallocate(T *p, std::size_t) noexcept {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  template<typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return true;
+  }
+  template<typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return false;
+  }
+};
+
+// Row stride (in elements) that keeps every row of an n-wide matrix cache line aligned.
+template<typename T>
+int aligned_stride(int n) {
+  const int per_line = CACHE_LINE % sizeof(T) == 0 ? CACHE_LINE / sizeof(T) : 1;
+  return (n + per_line - 1) / per_line * per_line;
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_ALIGNED_ALLOCATOR_HPP_
@@ -0,0 +1,499 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_EXPRESSION_HPP_
+#define LINEAR_CORE_EXPRESSION_HPP_
+
+#include "thread_pool.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Linear {
+
+/*
+ * Lazy element-wise arithmetic for std::vector and Matrix.
+ *
+ * An operator whose operands are all lvalues (or other lazy expressions) returns an expression
+ * node that only remembers its operands; the work is done in one fused loop when the node is
+ * assigned or converted to a std::vector / Matrix. When one operand is a temporary std::vector
+ * or Matrix, its buffer is reused instead: the result is computed into it in place and returned,
+ * so a chain like `A * x - b - c` allocates only the product.
+ * Every operator therefore returns either a concrete container or a node holding references to
+ * lvalues. Such a node is only valid while those lvalues live and keep their values, so it has to
+ * be consumed within the full-expression that built it:
+ *   auto d = x - y;      // d refers to x and y
+ *   x[0] = 100;          // would change what d yields
+ *   return a - b;        // from an `auto` function, would dangle once the locals a and b are gone
+ * To catch the first case at compile time, a node converts to std::vector / Matrix and serves as an
+ * operand only as a temporary; `std::vector<T> r = d;` or `d + z` with a named node does not compile.
+ * eval() and the explicit Matrix constructor still materialize a named node on purpose.
+ * Nothing catches the second: give such functions a concrete return type.
+ */
+
+// Size parameter of Matrix / Vec whose size is only known at run time.
+const int DYNAMIC = 0;
+
+template<class T = double, int N = DYNAMIC>
+struct Matrix;
+
+template<class E, class T>
+struct VecExpr {
+  using value_type = T;
+
+  const E &self() const {
+    return static_cast<const E &>(*this);
+  }
+
+  std::vector<T> eval() const {
+    const E &e = self();
+    std::vector<T> res(e.size());
+    parallel_for(0, res.size(), res.size(), [&](int lo, int hi) {
+      for (int i = lo; i < hi; i++) {
+        res[i] = e[i];
+      }
+    });
+    return res;
+  }
+
+  operator std::vector<T>() const && {
+    return eval();
+  }
+};
+
+template<class E, class T>
+struct MatExpr {
+  using value_type = T;
+
+  const E &self() const {
+    return static_cast<const E &>(*this);
+  }
+};
+
+template<class T>
+struct is_vec_expr {
+ private:
+  template<class E, class V>
+  static std::true_type test(const VecExpr<E, V> *);
+  static std::false_type test(...);
+
+ public:
+  static const bool value = decltype(test(std::declval<std::decay_t<T> *>()))::value;
+};
+
+template<class T>
+struct is_mat_expr {
+ private:
+  template<class E, class V>
+  static std::true_type test(const MatExpr<E, V> *);
+  static std::false_type test(...);
+
+ public:
+  static const bool value = decltype(test(std::declval<std::decay_t<T> *>()))::value;
+};
+
+template<class T>
+struct is_std_vector : std::false_type {};
+template<class T>
+struct is_std_vector<std::vector<T>> : std::is_arithmetic<T> {};
+
+template<class T>
+struct is_matrix : std::false_type {};
+template<class T>
+struct is_matrix<Matrix<T>> : std::true_type {};
+
+// Operands of the operators: containers, and expression nodes unless they are named (lvalues).
+template<class T>
+const bool is_vector_like = is_std_vector<std::decay_t<T>>::value
+  || (is_vec_expr<T>::value && !std::is_lvalue_reference_v<T>);
+template<class T>
+const bool is_matrix_like = is_matrix<std::decay_t<T>>::value
+  || (is_mat_expr<T>::value && !std::is_lvalue_reference_v<T>);
+
+// True for a forwarded temporary container whose buffer may be reused.
+template<class T>
+const bool is_temporary = !std::is_reference_v<T> && !std::is_const_v<T>
+  && (is_std_vector<T>::value || is_matrix<T>::value);
+
+template<class T, class = void>
+struct expr_value {};
+template<class T>
+struct expr_value<T, std::enable_if_t<is_vector_like<T> || is_matrix_like<T>>> {
+  using type = typename std::decay_t<T>::value_type;
+};
+template<class T>
+using expr_value_t = typename expr_value<T>::type;
+
+struct AddOp {
+  template<class A, class B>
+  static auto apply(const A &a, const B &b) { return a + b; }
+};
+struct SubOp {
+  template<class A, class B>
+  static auto apply(const A &a, const B &b) { return a - b; }
+};
+struct MulOp {
+  template<class A, class B>
+  static auto apply(const A &a, const B &b) { return a * b; }
+};
+struct DivOp {
+  template<class A, class B>
+  static auto apply(const A &a, const B &b) { return a / b; }
+};
+
+/*
+ * Vector expression nodes.
+ */
+
+template<class T>
+struct VecRef : VecExpr<VecRef<T>, T> {
+  const T *ptr;
+  size_t n;
+  explicit VecRef(const std::vector<T> &v) : ptr(v.data()), n(v.size()) {
+  }
+  size_t size() const {
+    return n;
+  }
+  T operator[](size_t i) const {
+    return ptr[i];
+  }
+};
+
+template<class L, class R, class Op>
+struct VecBinary : VecExpr<VecBinary<L, R, Op>, typename L::value_type> {
+  L l;
+  R r;
+  VecBinary(const L &l, const R &r) : l(l), r(r) {
+  }
+  size_t size() const {
+    return l.size();
+  }
+  auto operator[](size_t i) const {
+    return Op::apply(l[i], r[i]);
+  }
+};
+
+template<class L, class Op>
+struct VecScalar : VecExpr<VecScalar<L, Op>, typename L::value_type> {
+  using T = typename L::value_type;
+  L l;
+  T k;
+  VecScalar(const L &l, const T &k) : l(l), k(k) {
+  }
+  size_t size() const {
+    return l.size();
+  }
+  auto operator[](size_t i) const {
+    return Op::apply(l[i], k);
+  }
+};
+
+template<class L>
+struct VecNeg : VecExpr<VecNeg<L>, typename L::value_type> {
+  L l;
+  explicit VecNeg(const L &l) : l(l) {
+  }
+  size_t size() const {
+    return l.size();
+  }
+  auto operator[](size_t i) const {
+    return -l[i];
+  }
+};
+
+template<class T>
+VecRef<T> vec_operand(const std::vector<T> &v) {
+  return VecRef<T>(v);
+}
+template<class E, class T>
+E vec_operand(const VecExpr<E, T> &e) {
+  return e.self();
+}
+
+template<class V>
+using vec_operand_t = decltype(vec_operand(std::declval<const std::decay_t<V> &>()));
+
+template<class F>
+void vec_for_each(size_t n, F &&f) {
+  parallel_for(0, n, n, [&](int lo, int hi) {
+    for (int i = lo; i < hi; i++) {
+      f(i);
+    }
+  });
+}
+
+template<class Op, class L, class R>
+auto vec_binary(L &&l, R &&r) {
+  if (l.size() != r.size()) {
+    throw std::runtime_error("Vectors have different dimensions!");
+  }
+  if constexpr (is_temporary<L>) {
+    vec_for_each(l.size(), [&](size_t i) { l[i] = Op::apply(l[i], r[i]); });
+    return std::move(l);
+  } else if constexpr (is_temporary<R>) {
+    vec_for_each(r.size(), [&](size_t i) { r[i] = Op::apply(l[i], r[i]); });
+    return std::move(r);
+  } else {
+    return VecBinary<vec_operand_t<L>, vec_operand_t<R>, Op>(vec_operand(l), vec_operand(r));
+  }
+}
+
+template<class Op, class L>
+auto vec_scalar(L &&l, const expr_value_t<L> &k) {
+  if constexpr (is_temporary<L>) {
+    vec_for_each(l.size(), [&](size_t i) { l[i] = Op::apply(l[i], k); });
+    return std::move(l);
+  } else {
+    return VecScalar<vec_operand_t<L>, Op>(vec_operand(l), k);
+  }
+}
+
+template<class L, class R, std::enable_if_t<is_vector_like<L> && is_vector_like<R>, int> = 0>
+auto operator+(L &&a, R &&b) {
+  return vec_binary<AddOp>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template<class L, class R, std::enable_if_t<is_vector_like<L> && is_vector_like<R>, int> = 0>
+auto operator-(L &&a, R &&b) {
+  return vec_binary<SubOp>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template<class L, std::enable_if_t<is_vector_like<L>, int> = 0>
+auto operator*(L &&a, const expr_value_t<L> &k) {
+  return vec_scalar<MulOp>(std::forward<L>(a), k);
+}
+
+template<class L, std::enable_if_t<is_vector_like<L>, int> = 0>
+auto operator/(L &&a, const expr_value_t<L> &k) {
+  return vec_scalar<DivOp>(std::forward<L>(a), k);
+}
+
+template<class L, std::enable_if_t<is_vector_like<L>, int> = 0>
+auto operator-(L &&a) {
+  if constexpr (is_temporary<L>) {
+    vec_for_each(a.size(), [&](size_t i) { a[i] = -a[i]; });
+    return std::move(a);
+  } else {
+    return VecNeg<vec_operand_t<L>>(vec_operand(a));
+  }
+}
+
+template<class T, class R, std::enable_if_t<is_vector_like<R>, int> = 0>
+std::vector<T> &operator+=(std::vector<T> &a, const R &b) {
+  if (a.size() != b.size()) {
+    throw std::runtime_error("Vectors have different dimensions!");
+  }
+  vec_for_each(a.size(), [&](size_t i) { a[i] += b[i]; });
+  return a;
+}
+
+template<class T, class R, std::enable_if_t<is_vector_like<R>, int> = 0>
+std::vector<T> &operator-=(std::vector<T> &a, const R &b) {
+  if (a.size() != b.size()) {
+    throw std::runtime_error("Vectors have different dimensions!");
+  }
+  vec_for_each(a.size(), [&](size_t i) { a[i] -= b[i]; });
+  return a;
+}
+
+template<class T>
+std::vector<T> &operator*=(std::vector<T> &a, const T &k) {
+  vec_for_each(a.size(), [&](size_t i) { a[i] *= k; });
+  return a;
+}
+
+// Materializes a vector expression; plain vectors are passed through without a copy.
+template<class T>
+const std::vector<T> &evaluate(const std::vector<T> &v) {
+  return v;
+}
+template<class E, class T>
+std::vector<T> evaluate(const VecExpr<E, T> &e) {
+  return e.eval();
+}
+
+/*
+ * Matrix expression nodes.
+ */
+
+template<class T>
+const Matrix<T> &evaluate(const Matrix<T> &m) {
+  return m;
+}
+template<class E, class T>
+Matrix<T> evaluate(const MatExpr<E, T> &e) {
+  return Matrix<T>(e);
+}
+
+template<class T>
+struct MatRef : MatExpr<MatRef<T>, T> {
+  const T *ptr;
+  int n, ld;
+  explicit MatRef(const Matrix<T> &m) : ptr(m.data()), n(m.n), ld(m.stride()) {
+  }
+  int size() const {
+    return n;
+  }
+  T operator()(int i, int j) const {
+    return ptr[size_t(i) * ld + j];
+  }
+};
+
+template<class L, class R, class Op>
+struct MatBinary : MatExpr<MatBinary<L, R, Op>, typename L::value_type> {
+  L l;
+  R r;
+  MatBinary(const L &l, const R &r) : l(l), r(r) {
+  }
+  int size() const {
+    return l.size();
+  }
+  auto operator()(int i, int j) const {
+    return Op::apply(l(i, j), r(i, j));
+  }
+};
+
+template<class L, class Op>
+struct MatScalar : MatExpr<MatScalar<L, Op>, typename L::value_type> {
+  using T = typename L::value_type;
+  L l;
+  T k;
+  MatScalar(const L &l, const T &k) : l(l), k(k) {
+  }
+  int size() const {
+    return l.size();
+  }
+  auto operator()(int i, int j) const {
+    return Op::apply(l(i, j), k);
+  }
+};
+
+template<class L>
+struct MatNeg : MatExpr<MatNeg<L>, typename L::value_type> {
+  L l;
+  explicit MatNeg(const L &l) : l(l) {
+  }
+  int size() const {
+    return l.size();
+  }
+  auto operator()(int i, int j) const {
+    return -l(i, j);
+  }
+};
+
+template<class T>
+MatRef<T> mat_operand(const Matrix<T> &m) {
+  return MatRef<T>(m);
+}
+template<class E, class T>
+E mat_operand(const MatExpr<E, T> &e) {
+  return e.self();
+}
+
+template<class M>
+using mat_operand_t = decltype(mat_operand(std::declval<const std::decay_t<M> &>()));
+
+// Calls f(i, j) for every element of an n x n matrix, rows split across the thread pool.
+template<class F>
+void mat_for_each(int n, F &&f) {
+  parallel_for(0, n, (long long) n * n, [&](int lo, int hi) {
+    for (int i = lo; i < hi; i++) {
+      for (int j = 0; j < n; j++) {
+        f(i, j);
+      }
+    }
+  });
+}
+
+template<class Op, class L, class R>
+auto mat_binary(L &&l, R &&r) {
+  if (l.size() != r.size()) {
+    throw std::runtime_error("Matrices have different sizes!");
+  }
+  if constexpr (is_temporary<L>) {
+    auto e = mat_operand(r);
+    mat_for_each(l.n, [&](int i, int j) { l.at(i, j) = Op::apply(l.at(i, j), e(i, j)); });
+    return std::move(l);
+  } else if constexpr (is_temporary<R>) {
+    auto e = mat_operand(l);
+    mat_for_each(r.n, [&](int i, int j) { r.at(i, j) = Op::apply(e(i, j), r.at(i, j)); });
+    return std::move(r);
+  } else {
+    return MatBinary<mat_operand_t<L>, mat_operand_t<R>, Op>(mat_operand(l), mat_operand(r));
+  }
+}
+
+template<class Op, class L>
+auto mat_scalar(L &&l, const expr_value_t<L> &k) {
+  if constexpr (is_temporary<L>) {
+    mat_for_each(l.n, [&](int i, int j) { l.at(i, j) = Op::apply(l.at(i, j), k); });
+    return std::move(l);
+  } else {
+    return MatScalar<mat_operand_t<L>, Op>(mat_operand(l), k);
+  }
+}
+
+template<class L, class R, std::enable_if_t<is_matrix_like<L> && is_matrix_like<R>, int> = 0>
+auto operator+(L &&a, R &&b) {
+  return mat_binary<AddOp>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template<class L, class R, std::enable_if_t<is_matrix_like<L> && is_matrix_like<R>, int> = 0>
+auto operator-(L &&a, R &&b) {
+  return mat_binary<SubOp>(std::forward<L>(a), std::forward<R>(b));
+}
+
+template<class L, std::enable_if_t<is_matrix_like<L>, int> = 0>
+auto operator*(L &&a, const expr_value_t<L> &k) {
+  return mat_scalar<MulOp>(std::forward<L>(a), k);
+}
+
+template<class L, std::enable_if_t<is_matrix_like<L>, int> = 0>
+auto operator-(L &&a) {
+  if constexpr (is_temporary<L>) {
+    mat_for_each(a.n, [&](int i, int j) { a.at(i, j) = -a.at(i, j); });
+    return std::move(a);
+  } else {
+    return MatNeg<mat_operand_t<L>>(mat_operand(a));
+  }
+}
+
+// Products involving a lazy matrix: the expression is evaluated once, then the usual kernels run.
+template<class L, class R, std::enable_if_t<is_matrix_like<L> && is_matrix_like<R> && (is_mat_expr<L>::value || is_mat_expr<R>::value), int> = 0>
+auto operator*(const L &a, const R &b) {
+  const auto &x = evaluate(a);
+  const auto &y = evaluate(b);
+  return x * y;
+}
+
+/*
+ * Matrix-vector product with either side lazy, fused into a single pass over the matrix expression.
+ */
+template<class M, class V, std::enable_if_t<is_matrix_like<M> && is_vector_like<V> && (is_mat_expr<M>::value || is_vec_expr<V>::value), int> = 0>
+auto operator*(const M &m, const V &v) {
+  using T = expr_value_t<M>;
+  auto e = mat_operand(m);
+  const auto &x = evaluate(v);
+  if (e.size() != x.size()) {
+    throw std::runtime_error("Matrix and vector have incompatible dimensions!");
+  }
+  const int n = e.size();
+  std::vector<T> res(n);
+  parallel_for(0, n, (long long) n * n, [&](int lo, int hi) {
+    for (int i = lo; i < hi; i++) {
+      T sum = 0;
+      for (int j = 0; j < n; j++) {
+        sum += e(i, j) * x[j];
+      }
+      res[i] = sum;
+    }
+  });
+  return res;
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_EXPRESSION_HPP_
@@ -0,0 +1,203 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_FIXED_MATRIX_HPP_
+#define LINEAR_CORE_FIXED_MATRIX_HPP_
+
+#include "matrix.hpp"
+#include "vec.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+namespace Linear {
+
+/*
+ * Square matrix of the compile-time size N in a row-major std::array: no heap allocation, and every
+ * loop has a constant trip count that the compiler unrolls for small N. It has the interface of
+ * Matrix<T> (n, rows by [], row_data, stride, transpose, products), so algorithms templated on
+ * Matrix<T, N> instantiate for both forms; arithmetic is eager, there are no expression nodes.
+ */
+template<class T, int N>
+struct Matrix {
+  static_assert(N > 0, "Matrix size must be positive");
+  using value_type = T;
+  static constexpr int n = N;
+  static constexpr int ld = N;
+
+  std::array<T, N * N> a{};
+
+  constexpr Matrix() = default;
+  // For code written for both forms; the size must be N.
+  explicit Matrix(int size) {
+    if (size != N) {
+      throw std::runtime_error("Bad matrix size!");
+    }
+  }
+  Matrix(const std::initializer_list<std::initializer_list<T>> &lst) {
+    if (lst.size() != N) {
+      throw std::runtime_error("Bad initializer!");
+    }
+    auto it = lst.begin();
+    for (int i = 0; i < N; i++, it++) {
+      if (it->size() != N) {
+        throw std::runtime_error("Bad initializer!");
+      }
+      std::copy(it->begin(), it->end(), row_data(i));
+    }
+  }
+  // Element-wise conversion from another precision or from a Matrix<T> of size N.
+  template<class T2, int N2>
+  explicit Matrix(const Matrix<T2, N2> &other) {
+    if (other.n != N) {
+      throw std::runtime_error("Matrices have different sizes!");
+    }
+    for (int i = 0; i < N; i++) {
+      std::copy(other.row_data(i), other.row_data(i) + N, row_data(i));
+    }
+  }
+
+  constexpr Matrix operator*(const Matrix &other) const {
+    Matrix res;
+    for (int i = 0; i < N; i++) {
+      for (int k = 0; k < N; k++) {
+        const T a_ik = a[i * N + k];
+        for (int j = 0; j < N; j++) {
+          res.a[i * N + j] += a_ik * other.a[k * N + j];
+        }
+      }
+    }
+    return res;
+  }
+  constexpr Matrix &operator*=(const Matrix &other) {
+    return *this = *this * other;
+  }
+  constexpr Matrix &operator+=(const Matrix &other) {
+    for (int i = 0; i < N * N; i++) {
+      a[i] += other.a[i];
+    }
+    return *this;
+  }
+  constexpr Matrix &operator-=(const Matrix &other) {
+    for (int i = 0; i < N * N; i++) {
+      a[i] -= other.a[i];
+    }
+    return *this;
+  }
+  constexpr Matrix &operator*=(const T &k) {
+    for (int i = 0; i < N * N; i++) {
+      a[i] *= k;
+    }
+    return *this;
+  }
+
+  constexpr Vec<T, N> operator*(const Vec<T, N> &x) const {
+    Vec<T, N> res;
+    matvec(x.data(), res.data());
+    return res;
+  }
+  std::vector<T> operator*(const std::vector<T> &x) const {
+    if (x.size() != N) {
+      throw std::runtime_error("Matrix and vector have incompatible dimensions!");
+    }
+    std::vector<T> res(N);
+    matvec(x.data(), res.data());
+    return res;
+  }
+
+  constexpr void matvec(const T *x, T *y) const {
+    for (int i = 0; i < N; i++) {
+      T sum = 0;
+      for (int j = 0; j < N; j++) {
+        sum += a[i * N + j] * x[j];
+      }
+      y[i] = sum;
+    }
+  }
+
+  MatrixRow<T> operator[](int i) {
+    return MatrixRow<T>(row_data(i), N);
+  }
+  MatrixRow<const T> operator[](int i) const {
+    return MatrixRow<const T>(row_data(i), N);
+  }
+
+  constexpr T &at(int i, int j) {
+    return a[i * N + j];
+  }
+  constexpr const T &at(int i, int j) const {
+    return a[i * N + j];
+  }
+
+  constexpr T *data() {
+    return a.data();
+  }
+  constexpr const T *data() const {
+    return a.data();
+  }
+  constexpr int stride() const {
+    return N;
+  }
+  constexpr T *row_data(int i) {
+    return a.data() + i * N;
+  }
+  constexpr const T *row_data(int i) const {
+    return a.data() + i * N;
+  }
+
+  constexpr Matrix transpose() const {
+    Matrix res;
+    for (int i = 0; i < N; i++) {
+      for (int j = 0; j < N; j++) {
+        res.a[i * N + j] = a[j * N + i];
+      }
+    }
+    return res;
+  }
+
+  constexpr bool operator==(const Matrix &other) const {
+    return a == other.a;
+  }
+
+  MatrixRowIterator<const T> begin() const {
+    return MatrixRowIterator<const T>(a.data(), N, N);
+  }
+  MatrixRowIterator<const T> end() const {
+    return MatrixRowIterator<const T>(a.data() + N * N, N, N);
+  }
+
+  constexpr size_t size() const {
+    return N;
+  }
+};
+
+template<class T, int N, std::enable_if_t<N != DYNAMIC, int> = 0>
+constexpr Matrix<T, N> operator+(Matrix<T, N> A, const Matrix<T, N> &B) {
+  return A += B;
+}
+
+template<class T, int N, std::enable_if_t<N != DYNAMIC, int> = 0>
+constexpr Matrix<T, N> operator-(Matrix<T, N> A, const Matrix<T, N> &B) {
+  return A -= B;
+}
+
+template<class T, int N, std::enable_if_t<N != DYNAMIC, int> = 0>
+constexpr Matrix<T, N> operator-(Matrix<T, N> A) {
+  return A *= T(-1);
+}
+
+template<class T, int N, std::enable_if_t<N != DYNAMIC, int> = 0>
+constexpr Matrix<T, N> operator*(Matrix<T, N> A, const T &k) {
+  return A *= k;
+}
+
+template<class T, int N, std::enable_if_t<N != DYNAMIC, int> = 0>
+constexpr Matrix<T, N> operator*(const T &k, Matrix<T, N> A) {
+  return A *= k;
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_FIXED_MATRIX_HPP_
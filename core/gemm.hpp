@@ -0,0 +1,374 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_GEMM_HPP_
+#define LINEAR_CORE_GEMM_HPP_
+
+#include "aligned_allocator.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define LINEAR_GEMM_AVX2 1
+#endif
+
+namespace Linear {
+
+/*
+ * Blocking parameters of the packed GEMM. MR x NR is the register tile of the micro-kernel,
+ * KC x NR panels of B live in L1, MC x KC blocks of A in L2 and KC x NC panels of B in L3.
+ */
+template<typename T>
+struct GemmBlocking {
+  static const int MR = 4;
+  static const int NR = 4;
+  static const int MC = 128;
+  static const int KC = 256;
+  static const int NC = 2048;
+};
+
+template<>
+struct GemmBlocking<double> {
+  static const int MR = 6;
+  static const int NR = 8;
+  static const int MC = 96;
+  static const int KC = 256;
+  static const int NC = 4080;
+};
+
+template<>
+struct GemmBlocking<float> {
+  static const int MR = 6;
+  static const int NR = 16;
+  static const int MC = 96;
+  static const int KC = 256;
+  static const int NC = 4080;
+};
+
+// Products smaller than this (in multiply-adds) skip packing and use the plain loop.
+const long long GEMM_SMALL = 32 * 32 * 32;
+
+/*
+ * The textbook i-j-k loop. Kept as the reference the blocked kernel is checked against.
+ */
+template<typename T>
+void gemm_reference(int m, int n, int k, T alpha, const T *A, int lda, const T *B, int ldb, T beta, T *C, int ldc) {
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < n; j++) {
+      T sum = 0;
+      for (int p = 0; p < k; p++) {
+        sum += A[size_t(i) * lda + p] * B[size_t(p) * ldb + j];
+      }
+      C[size_t(i) * ldc + j] = alpha * sum + (beta == T(0) ? T(0) : beta * C[size_t(i) * ldc + j]);
+    }
+  }
+}
+
+template<typename T>
+void gemm_small(int m, int n, int k, T alpha, const T *A, int lda, const T *B, int ldb, T *C, int ldc) {
+  for (int i = 0; i < m; i++) {
+    T *c_i = C + size_t(i) * ldc;
+    for (int p = 0; p < k; p++) {
+      const T a_ip = alpha * A[size_t(i) * lda + p];
+      const T *b_p = B + size_t(p) * ldb;
+      for (int j = 0; j < n; j++) {
+        c_i[j] += a_ip * b_p[j];
+      }
+    }
+  }
+}
+
+// Packs an mc x kc block of A into MR-row panels, column by column, zero-padding the last panel.
+template<typename T>
+void gemm_pack_A(int mc, int kc, T alpha, const T *A, int lda, T *buf) {
+  const int MR = GemmBlocking<T>::MR;
+  for (int i0 = 0; i0 < mc; i0 += MR) {
+    const int mr = std::min(MR, mc - i0);
+    for (int p = 0; p < kc; p++) {
+      for (int i = 0; i < mr; i++) {
+        buf[i] = alpha * A[size_t(i0 + i) * lda + p];
+      }
+      for (int i = mr; i < MR; i++) {
+        buf[i] = 0;
+      }
+      buf += MR;
+    }
+  }
+}
+
+// Packs a kc x nc panel of B into NR-column panels, row by row, zero-padding the last panel.
+template<typename T>
+void gemm_pack_B(int kc, int nc, const T *B, int ldb, T *buf) {
+  const int NR = GemmBlocking<T>::NR;
+  for (int j0 = 0; j0 < nc; j0 += NR) {
+    const int nr = std::min(NR, nc - j0);
+    for (int p = 0; p < kc; p++) {
+      const T *b_p = B + size_t(p) * ldb + j0;
+      for (int j = 0; j < nr; j++) {
+        buf[j] = b_p[j];
+      }
+      for (int j = nr; j < NR; j++) {
+        buf[j] = 0;
+      }
+      buf += NR;
+    }
+  }
+}
+
+/*
+ * C[MR x NR] += A_panel * B_panel over kc. Portable version, written so that the
+ * accumulator tile stays in registers and the j loop vectorizes.
+ */
+template<typename T>
+void gemm_micro_kernel(int kc, const T *A, const T *B, T *C, int ldc) {
+  const int MR = GemmBlocking<T>::MR;
+  const int NR = GemmBlocking<T>::NR;
+  T acc[MR][NR] = {};
+  for (int p = 0; p < kc; p++, A += MR, B += NR) {
+    for (int i = 0; i < MR; i++) {
+      for (int j = 0; j < NR; j++) {
+        acc[i][j] += A[i] * B[j];
+      }
+    }
+  }
+  for (int i = 0; i < MR; i++) {
+    for (int j = 0; j < NR; j++) {
+      C[size_t(i) * ldc + j] += acc[i][j];
+    }
+  }
+}
+
+#ifdef LINEAR_GEMM_AVX2
+
+template<>
+inline void gemm_micro_kernel<double>(int kc, const double *A, const double *B, double *C, int ldc) {
+  __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+  __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+  __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+  __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+  __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+  __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+  for (int p = 0; p < kc; p++, A += 6, B += 8) {
+    const __m256d b0 = _mm256_load_pd(B);
+    const __m256d b1 = _mm256_load_pd(B + 4);
+    __m256d a = _mm256_broadcast_sd(A);
+    c00 = _mm256_fmadd_pd(a, b0, c00);
+    c01 = _mm256_fmadd_pd(a, b1, c01);
+    a = _mm256_broadcast_sd(A + 1);
+    c10 = _mm256_fmadd_pd(a, b0, c10);
+    c11 = _mm256_fmadd_pd(a, b1, c11);
+    a = _mm256_broadcast_sd(A + 2);
+    c20 = _mm256_fmadd_pd(a, b0, c20);
+    c21 = _mm256_fmadd_pd(a, b1, c21);
+    a = _mm256_broadcast_sd(A + 3);
+    c30 = _mm256_fmadd_pd(a, b0, c30);
+    c31 = _mm256_fmadd_pd(a, b1, c31);
+    a = _mm256_broadcast_sd(A + 4);
+    c40 = _mm256_fmadd_pd(a, b0, c40);
+    c41 = _mm256_fmadd_pd(a, b1, c41);
+    a = _mm256_broadcast_sd(A + 5);
+    c50 = _mm256_fmadd_pd(a, b0, c50);
+    c51 = _mm256_fmadd_pd(a, b1, c51);
+  }
+  auto store = [ldc, C](int i, __m256d lo, __m256d hi) {
+    double *c = C + size_t(i) * ldc;
+    _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), lo));
+    _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), hi));
+  };
+  store(0, c00, c01);
+  store(1, c10, c11);
+  store(2, c20, c21);
+  store(3, c30, c31);
+  store(4, c40, c41);
+  store(5, c50, c51);
+}
+
+template<>
+inline void gemm_micro_kernel<float>(int kc, const float *A, const float *B, float *C, int ldc) {
+  __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+  __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+  __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+  __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+  __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+  __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+  for (int p = 0; p < kc; p++, A += 6, B += 16) {
+    const __m256 b0 = _mm256_load_ps(B);
+    const __m256 b1 = _mm256_load_ps(B + 8);
+    __m256 a = _mm256_broadcast_ss(A);
+    c00 = _mm256_fmadd_ps(a, b0, c00);
+    c01 = _mm256_fmadd_ps(a, b1, c01);
+    a = _mm256_broadcast_ss(A + 1);
+    c10 = _mm256_fmadd_ps(a, b0, c10);
+    c11 = _mm256_fmadd_ps(a, b1, c11);
+    a = _mm256_broadcast_ss(A + 2);
+    c20 = _mm256_fmadd_ps(a, b0, c20);
+    c21 = _mm256_fmadd_ps(a, b1, c21);
+    a = _mm256_broadcast_ss(A + 3);
+    c30 = _mm256_fmadd_ps(a, b0, c30);
+    c31 = _mm256_fmadd_ps(a, b1, c31);
+    a = _mm256_broadcast_ss(A + 4);
+    c40 = _mm256_fmadd_ps(a, b0, c40);
+    c41 = _mm256_fmadd_ps(a, b1, c41);
+    a = _mm256_broadcast_ss(A + 5);
+    c50 = _mm256_fmadd_ps(a, b0, c50);
+    c51 = _mm256_fmadd_ps(a, b1, c51);
+  }
+  auto store = [ldc, C](int i, __m256 lo, __m256 hi) {
+    float *c = C + size_t(i) * ldc;
+    _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), lo));
+    _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), hi));
+  };
+  store(0, c00, c01);
+  store(1, c10, c11);
+  store(2, c20, c21);
+  store(3, c30, c31);
+  store(4, c40, c41);
+  store(5, c50, c51);
+}
+
+#endif
+
+// Runs the micro-kernel over one packed mc x nc block, spilling partial edge tiles through a local tile.
+template<typename T>
+void gemm_macro_kernel(int mc, int nc, int kc, const T *Ap, const T *Bp, T *C, int ldc) {
+  const int MR = GemmBlocking<T>::MR;
+  const int NR = GemmBlocking<T>::NR;
+  alignas(CACHE_LINE) T tile[MR * NR];
+  for (int j0 = 0; j0 < nc; j0 += NR) {
+    const int nr = std::min(NR, nc - j0);
+    const T *b = Bp + size_t(j0 / NR) * NR * kc;
+    for (int i0 = 0; i0 < mc; i0 += MR) {
+      const int mr = std::min(MR, mc - i0);
+      const T *a = Ap + size_t(i0 / MR) * MR * kc;
+      T *c = C + size_t(i0) * ldc + j0;
+      if (mr == MR && nr == NR) {
+        gemm_micro_kernel<T>(kc, a, b, c, ldc);
+      } else {
+        std::fill(tile, tile + MR * NR, T(0));
+        gemm_micro_kernel<T>(kc, a, b, tile, NR);
+        for (int i = 0; i < mr; i++) {
+          for (int j = 0; j < nr; j++) {
+            c[size_t(i) * ldc + j] += tile[i * NR + j];
+          }
+        }
+      }
+    }
+  }
+}
+
+// Per-thread packing buffer for blocks of A. A block is packed and used within one chunk, which never waits.
+template<typename T>
+std::vector<T, AlignedAllocator<T>> &gemm_buffer_A() {
+  thread_local std::vector<T, AlignedAllocator<T>> buffer;
+  return buffer;
+}
+
+/*
+ * Packing buffer for panels of B, one per nesting level of gemm on the calling thread. The panel is
+ * read by the helper chunks while the caller waits in parallel_for, and the waiting caller may run
+ * another gemm from the pool's queue: that one takes the next level instead of repacking this panel.
+ */
+template<typename T>
+class GemmPanelBuffer {
+  using Buffer = std::vector<T, AlignedAllocator<T>>;
+
+ public:
+  GemmPanelBuffer() : level(depth()++) {
+    auto &buffers = stack();
+    if (buffers.size() <= level) {
+      buffers.push_back(std::make_unique<Buffer>());
+    }
+  }
+  ~GemmPanelBuffer() {
+    depth()--;
+  }
+  GemmPanelBuffer(const GemmPanelBuffer &) = delete;
+  GemmPanelBuffer &operator=(const GemmPanelBuffer &) = delete;
+
+  Buffer &get() {
+    return *stack()[level];
+  }
+
+ private:
+  static size_t &depth() {
+    thread_local size_t d = 0;
+    return d;
+  }
+  static std::vector<std::unique_ptr<Buffer>> &stack() {
+    thread_local std::vector<std::unique_ptr<Buffer>> buffers;
+    return buffers;
+  }
+
+  size_t level;
+};
+
+/*
+ * C = alpha * A * B + beta * C for row-major A (m x k), B (k x n) and C (m x n)
+ * with leading dimensions lda, ldb and ldc.
+ */
+template<typename T>
+void gemm(int m, int n, int k, T alpha, const T *A, int lda, const T *B, int ldb, T beta, T *C, int ldc) {
+  if (m <= 0 || n <= 0) {
+    return;
+  }
+  if (beta != T(1)) {
+    for (int i = 0; i < m; i++) {
+      T *c_i = C + size_t(i) * ldc;
+      for (int j = 0; j < n; j++) {
+        c_i[j] = (beta == T(0) ? T(0) : beta * c_i[j]);
+      }
+    }
+  }
+  if (k <= 0 || alpha == T(0)) {
+    return;
+  }
+  if ((long long) m * n * k <= GEMM_SMALL) {
+    gemm_small(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+    return;
+  }
+
+  using Blocking = GemmBlocking<T>;
+  GemmPanelBuffer<T> panel;
+  auto &B_buf = panel.get();
+  B_buf.resize(size_t(Blocking::NC + Blocking::NR) * Blocking::KC);
+
+  const int ic_blocks = (m + Blocking::MC - 1) / Blocking::MC;
+  for (int jc = 0; jc < n; jc += Blocking::NC) {
+    const int nc = std::min(Blocking::NC, n - jc);
+    const int panels = (nc + Blocking::NR - 1) / Blocking::NR;
+    // When A has too few row blocks to feed every thread, the columns of B are split as well.
+    const int col_chunks = std::min(panels, std::max(1, num_threads() / ic_blocks));
+    for (int pc = 0; pc < k; pc += Blocking::KC) {
+      const int kc = std::min(Blocking::KC, k - pc);
+      gemm_pack_B(kc, nc, B + size_t(pc) * ldb + jc, ldb, B_buf.data());
+      const T *Bp = B_buf.data();
+      parallel_for(0, ic_blocks * col_chunks, (long long) m * nc * kc, [&](int lo, int hi) {
+        auto &A_buf = gemm_buffer_A<T>();
+        A_buf.resize(size_t(Blocking::MC + Blocking::MR) * Blocking::KC);
+        int packed = -1;
+        for (int t = lo; t < hi; t++) {
+          const int ib = t / col_chunks, jb = t % col_chunks;
+          const int ic = ib * Blocking::MC;
+          const int mc = std::min(Blocking::MC, m - ic);
+          if (packed != ib) {
+            gemm_pack_A(mc, kc, alpha, A + size_t(ic) * lda + pc, lda, A_buf.data());
+            packed = ib;
+          }
+          const int p0 = panels * jb / col_chunks, p1 = panels * (jb + 1) / col_chunks;
+          const int j0 = p0 * Blocking::NR, j1 = std::min(nc, p1 * Blocking::NR);
+          gemm_macro_kernel(mc, j1 - j0, kc, A_buf.data(), Bp + size_t(p0) * Blocking::NR * kc,
+                            C + size_t(ic) * ldc + jc + j0, ldc);
+        }
+      });
+    }
+  }
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_GEMM_HPP_
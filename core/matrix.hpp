@@ -5,25 +5,160 @@
 #ifndef LINEAR_CORE_MATRIX_HPP_
 #define LINEAR_CORE_MATRIX_HPP_
 
+#include "aligned_allocator.hpp"
+#include "expression.hpp"
+#include "gemm.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
 #include <exception>
 #include <iostream>
-#include <vector>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 namespace Linear {
 
-template<class T = double>
-struct Matrix {
-  std::vector<std::vector<T>> a;
+/*
+ * View of one row of a Matrix. Behaves like the std::vector rows the matrix used to store:
+ * indexable, iterable, convertible to std::vector and assignable from one.
+ */
+template<class T>
+class MatrixRow {
+  using value_type = std::remove_const_t<T>;
+
+  T *ptr;
+  int n;
+
+ public:
+  MatrixRow(T *ptr, int n) : ptr(ptr), n(n) {
+  }
+  MatrixRow(const MatrixRow &other) = default;
+
+  T &operator[](int j) const {
+    return ptr[j];
+  }
+
+  T *begin() const {
+    return ptr;
+  }
+  T *end() const {
+    return ptr + n;
+  }
+  T *data() const {
+    return ptr;
+  }
+  size_t size() const {
+    return n;
+  }
+
+  operator std::vector<value_type>() const {
+    return std::vector<value_type>(ptr, ptr + n);
+  }
+
+  const MatrixRow &operator=(const MatrixRow &other) const {
+    if (n != other.n) {
+      throw std::runtime_error("Rows have different sizes!");
+    }
+    std::copy(other.ptr, other.ptr + n, ptr);
+    return *this;
+  }
+  const MatrixRow &operator=(const std::vector<value_type> &v) const {
+    if (n != v.size()) {
+      throw std::runtime_error("Rows have different sizes!");
+    }
+    std::copy(v.begin(), v.end(), ptr);
+    return *this;
+  }
+
+  template<class T2>
+  friend class MatrixRowIterator;
+};
+
+template<class T>
+class MatrixRowIterator {
+  MatrixRow<T> row;
+  int stride;
+
+ public:
+  MatrixRowIterator(T *ptr, int n, int stride) : row(ptr, n), stride(stride) {
+  }
+  MatrixRowIterator(const MatrixRowIterator &other) = default;
+  MatrixRowIterator &operator=(const MatrixRowIterator &other) {
+    row.ptr = other.row.ptr;
+    row.n = other.row.n;
+    stride = other.stride;
+    return *this;
+  }
+
+  const MatrixRow<T> &operator*() const {
+    return row;
+  }
+  const MatrixRow<T> *operator->() const {
+    return &row;
+  }
+  MatrixRowIterator &operator++() {
+    row.ptr += stride;
+    return *this;
+  }
+  bool operator==(const MatrixRowIterator &other) const {
+    return row.ptr == other.row.ptr;
+  }
+  bool operator!=(const MatrixRowIterator &other) const {
+    return row.ptr != other.row.ptr;
+  }
+};
+
+template<class T>
+std::vector<std::remove_const_t<T>> operator*(const MatrixRow<T> &row, const std::remove_const_t<T> &k) {
+  std::vector<std::remove_const_t<T>> res(row.begin(), row.end());
+  for (auto &x : res) {
+    x *= k;
+  }
+  return res;
+}
+
+template<class T>
+std::vector<std::remove_const_t<T>> operator-(const MatrixRow<T> &row) {
+  return row * std::remove_const_t<T>(-1);
+}
+
+/*
+ * Square matrix stored in one cache line aligned row-major buffer.
+ * Row i starts at data() + i * stride(); the tail of every row past n is padding.
+ * The buffer is either owned or external memory (e.g. a mapped file, see matrix_file.hpp) that the
+ * matrix views without copying; copies of a matrix always own their buffer.
+ * This is Matrix<T> = Matrix<T, DYNAMIC>; Matrix<T, N> of a compile-time size is in fixed_matrix.hpp.
+ */
+template<class T>
+struct Matrix<T, DYNAMIC> {
+  using value_type = T;
 
   int n;
+  int ld;
+  std::vector<T, AlignedAllocator<T>> a;// empty for an external buffer
+  std::shared_ptr<T> external;          // the external buffer, kept alive while viewed
 
-  explicit Matrix(int n) : n(n) {
-    a.resize(n, std::vector<T>(n));
+  explicit Matrix(int n) : n(n), ld(aligned_stride<T>(n)), a(size_t(n) * ld) {
+  }
+  // View of the n x n values at external.get() with row stride ld; nothing is copied.
+  Matrix(int n, int ld, std::shared_ptr<T> external) : n(n), ld(ld), external(std::move(external)) {
+    if (ld < n || (n > 0 && !this->external)) {
+      throw std::runtime_error("Bad external buffer!");
+    }
+  }
+  Matrix(const Matrix &other) : n(other.n), ld(other.ld), a(other.data(), other.data() + size_t(n) * ld) {
   }
-  Matrix(const std::initializer_list<std::initializer_list<T>> &lst) : n(lst.size()) {
-    a.resize(n);
+  Matrix(Matrix &&other) noexcept = default;
+  Matrix &operator=(const Matrix &other) {
+    if (this != &other) {
+      *this = Matrix(other);
+    }
+    return *this;
+  }
+  Matrix &operator=(Matrix &&other) noexcept = default;
+  Matrix(const std::initializer_list<std::initializer_list<T>> &lst) : Matrix(int(lst.size())) {
     for (auto &inner : lst) {
       if (inner.size() != n) {
         throw std::runtime_error("Bad initializer!");
@@ -31,121 +166,166 @@ struct Matrix {
     }
     auto it = lst.begin();
     for (int i = 0; i < n; i++, it++) {
-      for (const T &j : *it) {
-        a[i].emplace_back(j);
-      }
+      std::copy(it->begin(), it->end(), a.begin() + size_t(i) * ld);
+    }
+  }
+  // Element-wise conversion from another precision or a fixed-size matrix, e.g. Matrix<float>(A) for a double A.
+  template<class T2, int N2>
+  explicit Matrix(const Matrix<T2, N2> &other) : Matrix(other.n) {
+    for (int i = 0; i < n; i++) {
+      std::copy(other.row_data(i), other.row_data(i) + n, row_data(i));
     }
   }
 
+  // Only a temporary expression converts implicitly; see expression.hpp.
+  template<class E>
+  Matrix(MatExpr<E, T> &&expr) : Matrix(expr.self().size()) {
+    assign(expr.self());
+  }
+  template<class E>
+  explicit Matrix(const MatExpr<E, T> &expr) : Matrix(expr.self().size()) {
+    assign(expr.self());
+  }
+
+  template<class E>
+  Matrix<T> &operator=(MatExpr<E, T> &&expr) {
+    if (n != expr.self().size()) {
+      *this = Matrix<T>(expr.self().size());
+    }
+    assign(expr.self());
+    return *this;
+  }
+
   Matrix<T> operator*(const Matrix<T> &other) const {
     if (n != other.n) {
       throw std::runtime_error("Matrices have different sizes!");
     }
     Matrix<T> res(n);
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-        for (int k = 0; k < n; k++) {
-          res[i][j] += a[i][k] * other[k][j];
-        }
-      }
-    }
+    gemm(n, n, n, T(1), data(), ld, other.data(), other.ld, T(0), res.data(), res.ld);
     return res;
   }
-  Matrix<T> operator*=(const Matrix<T> &other) {
+  Matrix<T> &operator*=(const Matrix<T> &other) {
     *this = *this * other;
     return *this;
   }
 
-  Matrix<T> operator+(const Matrix<T> &other) const {
-    if (n != other.n) {
+  template<class R, std::enable_if_t<is_matrix_like<R>, int> = 0>
+  Matrix<T> &operator+=(const R &other) {
+    if (n != other.size()) {
       throw std::runtime_error("Matrices have different sizes!");
     }
-    Matrix<T> res = *this;
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-        res[i][j] += other[i][j];
-      }
+    auto e = mat_operand(other);
+    mat_for_each(n, [&](int i, int j) { at(i, j) += e(i, j); });
+    return *this;
+  }
+  template<class R, std::enable_if_t<is_matrix_like<R>, int> = 0>
+  Matrix<T> &operator-=(const R &other) {
+    if (n != other.size()) {
+      throw std::runtime_error("Matrices have different sizes!");
     }
-    return res;
+    auto e = mat_operand(other);
+    mat_for_each(n, [&](int i, int j) { at(i, j) -= e(i, j); });
+    return *this;
   }
-  Matrix<T> operator+=(const Matrix<T> &other) {
-    *this = *this + other;
-    return *other;
+  Matrix<T> &operator*=(const T &k) {
+    mat_for_each(n, [&](int i, int j) { at(i, j) *= k; });
+    return *this;
   }
 
-  Matrix<T> operator-() const {
-    Matrix res(n);
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-        res[i][j] = -a[i][j];
-      }
+  std::vector<T> operator*(const std::vector<T> &k) const {
+    if (n != k.size()) {
+      std::cerr << n << " " << k.size() << "\n";
+      throw std::runtime_error("Matrix and vector have incompatible dimensions!");
     }
+    std::vector<T> res(n);
+    matvec(k.data(), res.data());
     return res;
   }
 
-  Matrix<T> operator-(const Matrix<T> &other) const {
-    return *this + (-other);
-  }
-  Matrix<T> operator-=(const Matrix<T> &other) {
-    *this = *this - other;
-    return *other;
+  // y = A * x, rows split across the thread pool.
+  void matvec(const T *x, T *y) const {
+    parallel_for(0, n, (long long) n * n, [&](int lo, int hi) {
+      for (int i = lo; i < hi; i++) {
+        const T *a_i = row_data(i);
+        T sum = 0;
+        for (int j = 0; j < n; j++) {
+          sum += a_i[j] * x[j];
+        }
+        y[i] = sum;
+      }
+    });
   }
 
-  Matrix<T> operator*(const T &k) const {
-    Matrix<T> res = *this;
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-        res[i][j] *= k;
-      }
-    }
-    return res;
+  MatrixRow<T> operator[](int i) {
+    return MatrixRow<T>(row_data(i), n);
   }
-  Matrix<T> operator*=(const T &k) const {
-    *this = *this * k;
-    return this;
+  MatrixRow<const T> operator[](int i) const {
+    return MatrixRow<const T>(row_data(i), n);
   }
 
-  std::vector<T> operator*(const std::vector<T> &k) const {
-    if (n != k.size()) {
-      std::cerr << n << " " << k.size() << "\n";
-      throw std::runtime_error("Matrix and vector have incompatible dimensions!");
-    }
-    std::vector<T> res(n);
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-        res[i] += a[i][j] * k[j];
-      }
-    }
-    return res;
+  T &at(int i, int j) {
+    return data()[size_t(i) * ld + j];
+  }
+  const T &at(int i, int j) const {
+    return data()[size_t(i) * ld + j];
   }
 
-  std::vector<T> &operator[](int i) {
-    return a[i];
+  T *data() {
+    return (external ? external.get() : a.data());
+  }
+  const T *data() const {
+    return (external ? external.get() : a.data());
+  }
+  bool is_external() const {
+    return external != nullptr;
   }
-  const std::vector<T> &operator[](int i) const {
-    return a[i];
+  int stride() const {
+    return ld;
+  }
+  T *row_data(int i) {
+    return data() + size_t(i) * ld;
+  }
+  const T *row_data(int i) const {
+    return data() + size_t(i) * ld;
   }
 
   Matrix<T> transpose() const {
+    const int B = 32;
     Matrix<T> res(n);
-    for (int i = 0; i < n; i++) {
-      for (int j = 0; j < n; j++) {
-        res[i][j] = a[j][i];
+    const T *src = data();
+    T *dst = res.data();
+    parallel_for(0, (n + B - 1) / B, (long long) n * n, [&](int lo, int hi) {
+      for (int i0 = lo * B; i0 < std::min(n, hi * B); i0 += B) {
+        for (int j0 = 0; j0 < n; j0 += B) {
+          for (int i = i0; i < std::min(n, i0 + B); i++) {
+            for (int j = j0; j < std::min(n, j0 + B); j++) {
+              dst[size_t(i) * res.ld + j] = src[size_t(j) * ld + i];
+            }
+          }
+        }
       }
-    }
+    });
     return res;
   }
 
-  bool operator ==(const Matrix<T> &other) const {
-    return a == other.a;
+  bool operator==(const Matrix<T> &other) const {
+    if (n != other.n) {
+      return false;
+    }
+    for (int i = 0; i < n; i++) {
+      if (!std::equal(row_data(i), row_data(i) + n, other.row_data(i))) {
+        return false;
+      }
+    }
+    return true;
   }
 
-  auto begin() const {
-    return a.begin();
+  MatrixRowIterator<const T> begin() const {
+    return MatrixRowIterator<const T>(data(), n, ld);
   }
 
-  auto end() const {
-    return a.end();
+  MatrixRowIterator<const T> end() const {
+    return MatrixRowIterator<const T>(data() + size_t(n) * ld, n, ld);
   }
 
   size_t size() const {
@@ -153,14 +333,24 @@ struct Matrix {
   }
 
 
-  template<class T2>
-  friend std::ostream &operator<<(std::ostream &out, const Matrix<T2> &m);
+  // Evaluates an element-wise expression into this matrix. Safe when the expression reads *this.
+  template<class E>
+  void assign(const E &e) {
+    mat_for_each(n, [&](int i, int j) { at(i, j) = e(i, j); });
+  }
+
+  template<class T2, int N2>
+  friend std::ostream &operator<<(std::ostream &out, const Matrix<T2, N2> &m);
   template<class T2>
   friend std::istream &operator>>(std::istream &in, Matrix<T2> &m);
 };
 
 template<class T>
-std::ostream &operator<<(std::ostream &out, const Matrix<T> &m) {
+Matrix(const std::initializer_list<std::initializer_list<T>> &) -> Matrix<T>;
+Matrix(int) -> Matrix<double>;
+
+template<class T, int N>
+std::ostream &operator<<(std::ostream &out, const Matrix<T, N> &m) {
   for (auto &i : m) {
     for (auto &j : i) {
       out << j << " ";
@@ -185,4 +375,6 @@ std::istream &operator>>(std::istream &in, Matrix<T> &m) {
 
 }
 
+#include "fixed_matrix.hpp"
+
 #endif//LINEAR_CORE_MATRIX_HPP_
@@ -0,0 +1,150 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_MATRIX_BATCH_HPP_
+#define LINEAR_CORE_MATRIX_BATCH_HPP_
+
+#include "aligned_allocator.hpp"
+#include "matrix.hpp"
+#include "sym_tridiagonal.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace Linear {
+
+/*
+ * count matrices of the same size n in interleaved structure-of-arrays layout: the matrices are split
+ * into groups of LANES, and inside a group entry (i, j) of all LANES matrices is stored contiguously,
+ * so one loop over the lanes processes LANES matrices at once and vectorizes.
+ * Matrix k is lane k % LANES of group k / LANES; the lanes past count in the last group are zero.
+ */
+template<typename T = double>
+struct MatrixBatch {
+  using value_type = T;
+  static constexpr int LANES = 8;
+
+  int n;
+  int count;
+  std::vector<T, AlignedAllocator<T>> a;
+
+  MatrixBatch(int n, int count) : n(n), count(count), a(size_t(groups()) * n * n * LANES) {
+  }
+  explicit MatrixBatch(const std::vector<Matrix<T>> &matrices)
+      : MatrixBatch(matrices.empty() ? 0 : matrices[0].n, matrices.size()) {
+    for (int k = 0; k < count; k++) {
+      set(k, matrices[k]);
+    }
+  }
+
+  int groups() const {
+    return (count + LANES - 1) / LANES;
+  }
+
+  // The n * n * LANES values of group g; entry (i, j) of lane l is at [(i * n + j) * LANES + l].
+  T *group(int g) {
+    return a.data() + size_t(g) * n * n * LANES;
+  }
+  const T *group(int g) const {
+    return a.data() + size_t(g) * n * n * LANES;
+  }
+
+  T &operator()(int k, int i, int j) {
+    return group(k / LANES)[(size_t(i) * n + j) * LANES + k % LANES];
+  }
+  const T &operator()(int k, int i, int j) const {
+    return group(k / LANES)[(size_t(i) * n + j) * LANES + k % LANES];
+  }
+
+  Matrix<T> get(int k) const {
+    Matrix<T> res(n);
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        res[i][j] = (*this)(k, i, j);
+      }
+    }
+    return res;
+  }
+
+  void set(int k, const Matrix<T> &A) {
+    if (A.n != n) {
+      throw std::runtime_error("Matrices have different sizes!");
+    }
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        (*this)(k, i, j) = A[i][j];
+      }
+    }
+  }
+
+  size_t size() const {
+    return count;
+  }
+};
+
+/*
+ * count symmetric tridiagonal matrices of size n in the layout of MatrixBatch: d[i] of lane l of
+ * group g is at d[(g * n + i) * LANES + l], e[i] at e[(g * (n - 1) + i) * LANES + l].
+ */
+template<typename T = double>
+struct SymTridiagonalBatch {
+  static constexpr int LANES = MatrixBatch<T>::LANES;
+
+  int n;
+  int count;
+  std::vector<T, AlignedAllocator<T>> d;
+  std::vector<T, AlignedAllocator<T>> e;
+
+  SymTridiagonalBatch(int n, int count)
+      : n(n), count(count), d(size_t(groups()) * n * LANES), e(size_t(groups()) * std::max(n - 1, 0) * LANES) {
+  }
+
+  int groups() const {
+    return (count + LANES - 1) / LANES;
+  }
+
+  T *diagonal(int g) {
+    return d.data() + size_t(g) * n * LANES;
+  }
+  const T *diagonal(int g) const {
+    return d.data() + size_t(g) * n * LANES;
+  }
+  T *off_diagonal(int g) {
+    return e.data() + size_t(g) * std::max(n - 1, 0) * LANES;
+  }
+  const T *off_diagonal(int g) const {
+    return e.data() + size_t(g) * std::max(n - 1, 0) * LANES;
+  }
+
+  SymTridiagonal<T> get(int k) const {
+    SymTridiagonal<T> res(n);
+    for (int i = 0; i < n; i++) {
+      res.d[i] = diagonal(k / LANES)[i * LANES + k % LANES];
+    }
+    for (int i = 0; i + 1 < n; i++) {
+      res.e[i] = off_diagonal(k / LANES)[i * LANES + k % LANES];
+    }
+    return res;
+  }
+
+  void set(int k, const SymTridiagonal<T> &A) {
+    if (A.n != n) {
+      throw std::runtime_error("Matrices have different sizes!");
+    }
+    for (int i = 0; i < n; i++) {
+      diagonal(k / LANES)[i * LANES + k % LANES] = A.d[i];
+    }
+    for (int i = 0; i + 1 < n; i++) {
+      off_diagonal(k / LANES)[i * LANES + k % LANES] = A.e[i];
+    }
+  }
+
+  size_t size() const {
+    return count;
+  }
+};
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_MATRIX_BATCH_HPP_
@@ -0,0 +1,347 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_MATRIX_FILE_HPP_
+#define LINEAR_CORE_MATRIX_FILE_HPP_
+
+#include "aligned_allocator.hpp"
+#include "matrix.hpp"
+#include "sparse_matrix.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+static_assert(sizeof(int) == 4, "Matrix files store 32-bit indices");
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LINEAR_HAS_MMAP 1
+#endif
+
+namespace Linear {
+
+/*
+ * Binary matrix file, little-endian:
+ *   64-byte MatrixFileHeader,
+ *   payload at header.offset (a multiple of 64):
+ *     dense: rows x ld values of dtype, row-major, the tail of every row past cols is padding;
+ *     csr:   row_ptr (rows + 1 int32), col (nnz int32), val (nnz values of dtype),
+ *            every array starting at a multiple of 64 bytes;
+ *     tiled: ld x ld tiles, row-major within a tile and in tile order, edge tiles padded with zeros
+ *            (the out-of-core TiledMatrix of tiled_matrix.hpp).
+ * A dense file of the matching dtype is mapped and viewed by load_matrix without copying.
+ * NumPy reads it with np.memmap(path, dtype, mode="r", offset=offset, shape=(rows, ld))[:, :cols].
+ */
+
+const uint32_t MATRIX_FILE_VERSION = 1;
+const char MATRIX_FILE_MAGIC[8] = {'L', 'I', 'N', 'M', 'A', 'T', 'R', 'X'};
+
+enum class MatrixDType : uint32_t {
+  float32 = 1,
+  float64 = 2
+};
+
+enum class MatrixLayout : uint32_t {
+  dense = 0,// row-major
+  csr = 1,
+  tiled = 2
+};
+
+struct MatrixFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t dtype;
+  uint32_t layout;
+  uint32_t reserved;
+  uint64_t rows;
+  uint64_t cols;
+  uint64_t ld; // row stride of a dense payload or tile size of a tiled one, in elements
+  uint64_t nnz;// entries of a csr payload
+  uint64_t offset;
+};
+static_assert(sizeof(MatrixFileHeader) == 64, "The matrix file header must take 64 bytes");
+
+template<typename T>
+constexpr MatrixDType matrix_dtype() {
+  static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "Only float and double matrices are stored");
+  return (std::is_same_v<T, float> ? MatrixDType::float32 : MatrixDType::float64);
+}
+
+inline size_t dtype_size(uint32_t dtype) {
+  switch (MatrixDType(dtype)) {
+    case MatrixDType::float32:
+      return 4;
+    case MatrixDType::float64:
+      return 8;
+  }
+  throw std::runtime_error("Unknown matrix dtype!");
+}
+
+inline uint64_t align_offset(uint64_t offset) {
+  return (offset + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+// Byte offsets of the col and val arrays of a csr payload.
+inline std::pair<uint64_t, uint64_t> csr_offsets(const MatrixFileHeader &h) {
+  uint64_t col = align_offset(h.offset + 4 * (h.rows + 1));
+  return {col, align_offset(col + 4 * h.nnz)};
+}
+
+// Tiles per side of a tiled payload.
+inline uint64_t tile_count(const MatrixFileHeader &h) {
+  return (h.rows + h.ld - 1) / h.ld;
+}
+
+namespace detail {
+
+inline MatrixFileHeader make_header(MatrixDType dtype, MatrixLayout layout, uint64_t n) {
+  MatrixFileHeader h{};
+  std::memcpy(h.magic, MATRIX_FILE_MAGIC, sizeof(h.magic));
+  h.version = MATRIX_FILE_VERSION;
+  h.dtype = uint32_t(dtype);
+  h.layout = uint32_t(layout);
+  h.rows = h.cols = n;
+  h.offset = align_offset(sizeof(MatrixFileHeader));
+  return h;
+}
+
+inline void pad_to(std::ofstream &out, uint64_t offset) {
+  static const char zeros[CACHE_LINE] = {};
+  uint64_t pos = out.tellp();
+  out.write(zeros, std::streamsize(offset - pos));
+}
+
+/*
+ * The whole file in memory: mapped read-only-shared / copy-on-write where mmap exists,
+ * read into an aligned buffer otherwise. Writes through the result never reach the file.
+ */
+struct FileBuffer {
+  std::shared_ptr<char> data;
+  size_t size = 0;
+};
+
+inline FileBuffer map_file(const std::string &path) {
+  FileBuffer res;
+#ifdef LINEAR_HAS_MMAP
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open matrix file!");
+  }
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Cannot open matrix file!");
+  }
+  res.size = st.st_size;
+  void *p = (res.size > 0 ? ::mmap(nullptr, res.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED);
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    throw std::runtime_error("Cannot map matrix file!");
+  }
+  size_t size = res.size;
+  res.data = std::shared_ptr<char>(static_cast<char *>(p), [size](char *q) { ::munmap(q, size); });
+#else
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) {
+    throw std::runtime_error("Cannot open matrix file!");
+  }
+  res.size = in.tellg();
+  auto buffer = std::make_shared<std::vector<char, AlignedAllocator<char>>>(res.size);
+  in.seekg(0);
+  in.read(buffer->data(), std::streamsize(res.size));
+  res.data = std::shared_ptr<char>(buffer, buffer->data());
+#endif
+  return res;
+}
+
+inline MatrixFileHeader read_header(const FileBuffer &file) {
+  MatrixFileHeader h;
+  if (file.size < sizeof(h)) {
+    throw std::runtime_error("Not a matrix file!");
+  }
+  std::memcpy(&h, file.data.get(), sizeof(h));
+  if (std::memcmp(h.magic, MATRIX_FILE_MAGIC, sizeof(h.magic)) != 0) {
+    throw std::runtime_error("Not a matrix file!");
+  }
+  if (h.version != MATRIX_FILE_VERSION) {
+    throw std::runtime_error("Unsupported matrix file version!");
+  }
+  if (h.rows != h.cols) {
+    throw std::runtime_error("Only square matrices are supported!");
+  }
+  const size_t value = dtype_size(h.dtype);
+  uint64_t end = 0;
+  if (h.layout == uint32_t(MatrixLayout::dense)) {
+    if (h.ld < h.cols) {
+      throw std::runtime_error("Bad matrix file!");
+    }
+    end = h.offset + h.rows * h.ld * value;
+  } else if (h.layout == uint32_t(MatrixLayout::csr)) {
+    end = csr_offsets(h).second + h.nnz * value;
+  } else if (h.layout == uint32_t(MatrixLayout::tiled)) {
+    if (h.ld == 0) {
+      throw std::runtime_error("Bad matrix file!");
+    }
+    end = h.offset + tile_count(h) * tile_count(h) * h.ld * h.ld * value;
+  } else {
+    throw std::runtime_error("Unknown matrix layout!");
+  }
+  if (h.offset % CACHE_LINE != 0 || end > file.size) {
+    throw std::runtime_error("Bad matrix file!");
+  }
+  return h;
+}
+
+template<typename T, typename S>
+void convert(const char *from, size_t count, T *to) {
+  for (size_t i = 0; i < count; i++) {
+    S x;
+    std::memcpy(&x, from + i * sizeof(S), sizeof(S));
+    to[i] = T(x);
+  }
+}
+
+template<typename T>
+void convert(uint32_t dtype, const char *from, size_t count, T *to) {
+  if (MatrixDType(dtype) == MatrixDType::float32) {
+    convert<T, float>(from, count, to);
+  } else {
+    convert<T, double>(from, count, to);
+  }
+}
+
+}// namespace detail
+
+template<typename T>
+SparseMatrix<T> load_sparse_matrix(const std::string &path);
+
+template<typename T>
+void save_matrix(const std::string &path, const Matrix<T> &A) {
+  auto h = detail::make_header(matrix_dtype<T>(), MatrixLayout::dense, A.n);
+  h.ld = A.stride();
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("Cannot open matrix file!");
+  }
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  detail::pad_to(out, h.offset);
+  for (int i = 0; i < A.n; i++) {
+    out.write(reinterpret_cast<const char *>(A.row_data(i)), std::streamsize(sizeof(T)) * A.n);
+    for (int j = A.n; j < A.stride(); j++) {
+      const T zero = 0;
+      out.write(reinterpret_cast<const char *>(&zero), sizeof(T));
+    }
+  }
+  if (!out) {
+    throw std::runtime_error("Cannot write matrix file!");
+  }
+}
+
+template<typename T>
+void save_matrix(const std::string &path, const SparseMatrix<T> &A) {
+  auto h = detail::make_header(matrix_dtype<T>(), MatrixLayout::csr, A.n);
+  h.nnz = A.nnz();
+  auto [col_offset, val_offset] = csr_offsets(h);
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("Cannot open matrix file!");
+  }
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  detail::pad_to(out, h.offset);
+  out.write(reinterpret_cast<const char *>(A.row_ptr.data()), std::streamsize(4 * A.row_ptr.size()));
+  detail::pad_to(out, col_offset);
+  out.write(reinterpret_cast<const char *>(A.col.data()), std::streamsize(4 * A.col.size()));
+  detail::pad_to(out, val_offset);
+  out.write(reinterpret_cast<const char *>(A.val.data()), std::streamsize(sizeof(T) * A.val.size()));
+  if (!out) {
+    throw std::runtime_error("Cannot write matrix file!");
+  }
+}
+
+/*
+ * Loads a matrix file as a dense Matrix<T>. A dense payload of dtype T is mapped and viewed in place
+ * (copy-on-write: changing the matrix does not change the file); another dtype is converted and
+ * csr and tiled payloads are expanded into an owned matrix.
+ */
+template<typename T>
+Matrix<T> load_matrix(const std::string &path) {
+  auto file = detail::map_file(path);
+  auto h = detail::read_header(file);
+  const int n = h.rows;
+  const char *payload = file.data.get() + h.offset;
+  if (h.layout == uint32_t(MatrixLayout::dense)) {
+    if (h.dtype == uint32_t(matrix_dtype<T>())) {
+      T *values = reinterpret_cast<T *>(file.data.get() + h.offset);// offset is 64-aligned
+      return Matrix<T>(n, h.ld, std::shared_ptr<T>(file.data, values));
+    }
+    Matrix<T> res(n);
+    const size_t value = dtype_size(h.dtype);
+    for (int i = 0; i < n; i++) {
+      detail::convert(h.dtype, payload + i * h.ld * value, n, res.row_data(i));
+    }
+    return res;
+  }
+  if (h.layout == uint32_t(MatrixLayout::tiled)) {
+    Matrix<T> res(n);
+    const int tile = h.ld, tiles = tile_count(h);
+    const size_t value = dtype_size(h.dtype);
+    for (int ti = 0; ti < tiles; ti++) {
+      for (int tj = 0; tj < tiles; tj++) {
+        const char *t = payload + (size_t(ti) * tiles + tj) * tile * tile * value;
+        const int cols = std::min(tile, n - tj * tile);
+        for (int i = 0; i < std::min(tile, n - ti * tile); i++) {
+          detail::convert(h.dtype, t + size_t(i) * tile * value, cols, res.row_data(ti * tile + i) + tj * tile);
+        }
+      }
+    }
+    return res;
+  }
+  return load_sparse_matrix<T>(path).to_matrix();
+}
+
+// Loads a matrix file as a SparseMatrix<T>; a dense or tiled payload keeps its nonzero entries.
+template<typename T>
+SparseMatrix<T> load_sparse_matrix(const std::string &path) {
+  auto file = detail::map_file(path);
+  auto h = detail::read_header(file);
+  if (h.layout != uint32_t(MatrixLayout::csr)) {
+    return SparseMatrix<T>(load_matrix<T>(path));
+  }
+  const int n = h.rows;
+  auto [col_offset, val_offset] = csr_offsets(h);
+  SparseMatrix<T> res(n);
+  res.col.resize(h.nnz);
+  res.val.resize(h.nnz);
+  std::memcpy(res.row_ptr.data(), file.data.get() + h.offset, 4 * res.row_ptr.size());
+  std::memcpy(res.col.data(), file.data.get() + col_offset, 4 * h.nnz);
+  detail::convert(h.dtype, file.data.get() + val_offset, h.nnz, res.val.data());
+  if (res.row_ptr[0] != 0 || uint64_t(res.row_ptr[n]) != h.nnz) {
+    throw std::runtime_error("Bad matrix file!");
+  }
+  for (int i = 0; i < n; i++) {
+    if (res.row_ptr[i] > res.row_ptr[i + 1]) {
+      throw std::runtime_error("Bad matrix file!");
+    }
+  }
+  for (int j : res.col) {
+    if (j < 0 || j >= n) {
+      throw std::runtime_error("Bad matrix file!");
+    }
+  }
+  return res;
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_MATRIX_FILE_HPP_
@@ -0,0 +1,103 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_REPORT_HPP_
+#define LINEAR_CORE_REPORT_HPP_
+
+#include <chrono>
+
+namespace Linear {
+
+enum class StopReason {
+  converged,
+  iteration_limit,// LIMIT iterations without convergence
+  diverged,       // the iterates kept growing
+  breakdown,      // the method cannot go on, e.g. a Krylov subspace became invariant or A is not SPD
+  fallback        // the method gave up and the result comes from a more robust one, e.g. LU in full precision
+};
+
+/*
+ * Filled in by an iterative solver when a pointer to it is passed: the number of iterations done,
+ * the residual of the last iterate, why the method stopped and its wall time. The residual is the
+ * quantity the method tests against EPS: |b - A * x| for linear solvers, |A * v - lambda * v| for
+ * eigen_simple_iteration, the largest Gershgorin radius for eigen_qr and the largest subdiagonal
+ * element neglected at a deflation for eigen_qr_shift and eigen_francis.
+ */
+struct SolverReport {
+  int iterations = 0;
+  double residual = 0;
+  StopReason reason = StopReason::converged;
+  double seconds = 0;
+};
+
+/*
+ * Receives the progress of an iterative solver it is passed to. The default hooks do nothing,
+ * so an observer overrides only what it needs.
+ */
+class SolverObserver {
+ public:
+  virtual ~SolverObserver() = default;
+
+  // After every iteration (counted from 1): the residual as in SolverReport and the wall time of the step.
+  // eigen_qr_shift and eigen_francis pass the magnitude of the subdiagonal element they are driving to zero.
+  virtual void on_iteration(int /*iteration*/, double /*residual*/, double /*seconds*/) {
+  }
+  // eigen_qr_shift, eigen_francis: the eigenvalue at index split off after iteration.
+  virtual void on_deflation(int /*index*/, int /*iteration*/) {
+  }
+  // Once, with the report of the whole run.
+  virtual void on_stop(const SolverReport & /*report*/) {
+  }
+};
+
+/*
+ * What a solver feeds its optional report and observer through. With neither, a step costs one branch
+ * and the clock is never read.
+ */
+class Telemetry {
+  using Clock = std::chrono::steady_clock;
+
+ public:
+  Telemetry(SolverReport *report, SolverObserver *observer) : report(report), observer(observer) {
+    if (report || observer) {
+      start = last = Clock::now();
+    }
+  }
+
+  void step(int iteration, double residual) {
+    if (observer) {
+      auto now = Clock::now();
+      observer->on_iteration(iteration, residual, std::chrono::duration<double>(now - last).count());
+      last = now;
+    }
+  }
+
+  void deflation(int index, int iteration) {
+    if (observer) {
+      observer->on_deflation(index, iteration);
+    }
+  }
+
+  void stop(StopReason reason, int iterations, double residual) {
+    if (!report && !observer) {
+      return;
+    }
+    SolverReport res{iterations, residual, reason, std::chrono::duration<double>(Clock::now() - start).count()};
+    if (report) {
+      *report = res;
+    }
+    if (observer) {
+      observer->on_stop(res);
+    }
+  }
+
+ private:
+  SolverReport *report;
+  SolverObserver *observer;
+  Clock::time_point start, last;
+};
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_REPORT_HPP_
@@ -0,0 +1,168 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_SPARSE_MATRIX_HPP_
+#define LINEAR_CORE_SPARSE_MATRIX_HPP_
+
+#include "matrix.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace Linear {
+
+/*
+ * Square matrix in compressed sparse row form: the entries of row i are val[row_ptr[i]..row_ptr[i + 1])
+ * with column indices col[...] in increasing order. O(n + nnz) memory.
+ */
+template<typename T = double>
+struct SparseMatrix {
+  using value_type = T;
+
+  int n;
+  std::vector<int> row_ptr;
+  std::vector<int> col;
+  std::vector<T> val;
+
+  explicit SparseMatrix(int n) : n(n), row_ptr(n + 1) {
+  }
+  // Keeps the nonzero entries of A.
+  explicit SparseMatrix(const Matrix<T> &A) : SparseMatrix(A.n) {
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        if (A[i][j] != T(0)) {
+          col.push_back(j);
+          val.push_back(A[i][j]);
+        }
+      }
+      row_ptr[i + 1] = col.size();
+    }
+  }
+
+  Matrix<T> to_matrix() const {
+    Matrix<T> res(n);
+    for (int i = 0; i < n; i++) {
+      for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++) {
+        res[i][col[k]] = val[k];
+      }
+    }
+    return res;
+  }
+
+  operator Matrix<T>() const {
+    return to_matrix();
+  }
+
+  std::vector<T> operator*(const std::vector<T> &x) const {
+    if (x.size() != n) {
+      throw std::runtime_error("Matrix and vector have incompatible dimensions!");
+    }
+    std::vector<T> res(n);
+    matvec(x.data(), res.data());
+    return res;
+  }
+
+  // y = A * x, rows split across the thread pool.
+  void matvec(const T *x, T *y) const {
+    parallel_for(0, n, 2LL * nnz(), [&](int lo, int hi) {
+      for (int i = lo; i < hi; i++) {
+        T sum = 0;
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; k++) {
+          sum += val[k] * x[col[k]];
+        }
+        y[i] = sum;
+      }
+    });
+  }
+
+  // Entry (i, j), zero if it is not stored; O(log(row length)).
+  T at(int i, int j) const {
+    auto first = col.begin() + row_ptr[i], last = col.begin() + row_ptr[i + 1];
+    auto it = std::lower_bound(first, last, j);
+    return (it != last && *it == j ? val[it - col.begin()] : T(0));
+  }
+
+  size_t nnz() const {
+    return val.size();
+  }
+
+  size_t size() const {
+    return n;
+  }
+};
+
+/*
+ * Collects (row, column, value) entries in any order, e.g. the edges of a graph,
+ * and compresses them into a SparseMatrix; repeated entries are summed.
+ */
+template<typename T = double>
+struct SparseMatrixBuilder {
+  struct Entry {
+    int row, col;
+    T value;
+  };
+
+  int n;
+  std::vector<Entry> entries;
+
+  explicit SparseMatrixBuilder(int n) : n(n) {
+  }
+
+  void add(int i, int j, T value = T(1)) {
+    if (i < 0 || i >= n || j < 0 || j >= n) {
+      throw std::runtime_error("Index out of range!");
+    }
+    entries.push_back({i, j, value});
+  }
+
+  void reserve(size_t count) {
+    entries.reserve(count);
+  }
+
+  SparseMatrix<T> build() const {
+    SparseMatrix<T> res(n);
+    // bucket the entries by row, then sort and merge every row
+    std::vector<int> start(n + 1);
+    for (auto &e : entries) {
+      start[e.row + 1]++;
+    }
+    for (int i = 0; i < n; i++) {
+      start[i + 1] += start[i];
+    }
+    std::vector<std::pair<int, T>> by_row(entries.size());
+    std::vector<int> pos(start.begin(), start.end() - 1);
+    for (auto &e : entries) {
+      by_row[pos[e.row]++] = {e.col, e.value};
+    }
+
+    res.col.reserve(entries.size());
+    res.val.reserve(entries.size());
+    for (int i = 0; i < n; i++) {
+      auto first = by_row.begin() + start[i], last = by_row.begin() + start[i + 1];
+      std::sort(first, last, [](auto &a, auto &b) { return a.first < b.first; });
+      for (auto it = first; it != last; it++) {
+        if (res.col.size() > size_t(res.row_ptr[i]) && res.col.back() == it->first) {
+          res.val.back() += it->second;
+        } else {
+          res.col.push_back(it->first);
+          res.val.push_back(it->second);
+        }
+      }
+      res.row_ptr[i + 1] = res.col.size();
+    }
+    return res;
+  }
+};
+
+template<class T>
+std::ostream &operator<<(std::ostream &out, const SparseMatrix<T> &m) {
+  return out << m.to_matrix();
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_SPARSE_MATRIX_HPP_
@@ -0,0 +1,82 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_SYM_TRIDIAGONAL_HPP_
+#define LINEAR_CORE_SYM_TRIDIAGONAL_HPP_
+
+#include "matrix.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace Linear {
+
+/*
+ * Symmetric tridiagonal matrix: diagonal d[0..n-1] and off-diagonal e[0..n-2],
+ * e[i] being the entry at (i, i + 1) and (i + 1, i). O(n) memory.
+ */
+template<typename T = double>
+struct SymTridiagonal {
+  int n;
+  std::vector<T> d;
+  std::vector<T> e;
+
+  explicit SymTridiagonal(int n) : n(n), d(n), e(std::max(n - 1, 0)) {
+  }
+  SymTridiagonal(std::vector<T> d, std::vector<T> e) : n(d.size()), d(std::move(d)), e(std::move(e)) {
+    if (this->e.size() != size_t(std::max(n - 1, 0))) {
+      throw std::runtime_error("Bad tridiagonal dimensions!");
+    }
+  }
+  // Takes the diagonal and the subdiagonal of A; everything else is assumed to be zero.
+  explicit SymTridiagonal(const Matrix<T> &A) : SymTridiagonal(A.n) {
+    for (int i = 0; i < n; i++) {
+      d[i] = A[i][i];
+    }
+    for (int i = 0; i + 1 < n; i++) {
+      e[i] = A[i + 1][i];
+    }
+  }
+
+  Matrix<T> to_matrix() const {
+    Matrix<T> res(n);
+    for (int i = 0; i < n; i++) {
+      res[i][i] = d[i];
+    }
+    for (int i = 0; i + 1 < n; i++) {
+      res[i][i + 1] = res[i + 1][i] = e[i];
+    }
+    return res;
+  }
+
+  std::vector<T> operator*(const std::vector<T> &x) const {
+    if (x.size() != n) {
+      throw std::runtime_error("Matrix and vector have incompatible dimensions!");
+    }
+    std::vector<T> res(n);
+    for (int i = 0; i < n; i++) {
+      res[i] = d[i] * x[i];
+      if (i > 0) {
+        res[i] += e[i - 1] * x[i - 1];
+      }
+      if (i + 1 < n) {
+        res[i] += e[i] * x[i + 1];
+      }
+    }
+    return res;
+  }
+
+  size_t size() const {
+    return n;
+  }
+};
+
+template<class T>
+std::ostream &operator<<(std::ostream &out, const SymTridiagonal<T> &m) {
+  return out << m.to_matrix();
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_SYM_TRIDIAGONAL_HPP_
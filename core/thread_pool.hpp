@@ -0,0 +1,384 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_THREAD_POOL_HPP_
+#define LINEAR_CORE_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Linear {
+
+// Loops with less work than this (roughly, in flops or touched elements) stay on the calling thread.
+const long long PARALLEL_THRESHOLD = 1 << 16;
+
+/*
+ * Fixed set of worker threads shared by the whole library.
+ * Every worker owns a deque: tasks submitted from a worker go to the back of its own deque and
+ * are taken from the back again (the most recent, cache-hot task first), while idle threads steal
+ * from the front of the others. Tasks submitted from outside the pool go to a shared queue.
+ * A thread that waits for its parallel_for or TaskGroup keeps executing queued tasks,
+ * so parallel work may be nested (e.g. a recursive solver or a solver loop calling Matrix::operator*).
+ * Those tasks may belong to anyone, not just to the awaited loop or group: while a kernel waits,
+ * its thread can run another instance of the same kernel. Hence state a kernel keeps per thread
+ * (thread_local buffers and the like) must not be in use across a wait, or has to be taken per
+ * nesting level as gemm does with its B panel.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(int threads) {
+    threads = std::max(threads, 1);
+    // queues[0] is the shared queue, queues[i] belongs to worker i
+    for (int i = 0; i < threads; i++) {
+      queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 1; i < threads; i++) {
+      workers.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Number of threads taking part in a parallel_for, the caller included.
+  int size() const {
+    return workers.size() + 1;
+  }
+
+  void submit(std::function<void()> task) {
+    Queue &q = *queues[current_pool() == this ? current_index() : 0];
+    {
+      std::lock_guard<std::mutex> lock(q.mutex);
+      q.tasks.push_back(std::move(task));
+    }
+    pending.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    cv.notify_one();
+  }
+
+  // Runs one queued task on the calling thread. Returns false if every queue was empty.
+  bool run_one() {
+    std::function<void()> task;
+    if (!take(task)) {
+      return false;
+    }
+    task();
+    return true;
+  }
+
+  /*
+   * Calls f(lo, hi) on disjoint chunks covering [begin, end), each at least `grain` long.
+   * Blocks until every chunk is done; the first exception thrown by f is rethrown here.
+   */
+  template<typename F>
+  void parallel_for(int begin, int end, int grain, F &&f) {
+    if (end <= begin) {
+      return;
+    }
+    grain = std::max(grain, 1);
+    const int chunks = std::min((end - begin + grain - 1) / grain, 4 * size());
+    if (chunks <= 1 || size() == 1) {
+      f(begin, end);
+      return;
+    }
+
+    /*
+     * The state lives on this frame and every helper gets a pointer to it, which fits the inline storage
+     * of std::function: a parallel_for allocates nothing beyond queue slots. Hence the helpers have to
+     * be waited for as well as the chunks, even the ones that start after every chunk is done.
+     */
+    struct State {
+      std::atomic<int> next{0};
+      std::atomic<int> done{0};
+      std::atomic<int> exited{0};
+      int chunks, begin, len;
+      std::remove_reference_t<F> *f;
+      std::exception_ptr error;
+      std::mutex error_mutex;
+
+      void run_chunks() {
+        for (int c; (c = next.fetch_add(1)) < chunks;) {
+          try {
+            (*f)(begin + (long long) len * c / chunks, begin + (long long) len * (c + 1) / chunks);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+              error = std::current_exception();
+            }
+          }
+          done.fetch_add(1);
+        }
+      }
+    };
+    State s;
+    s.chunks = chunks;
+    s.begin = begin;
+    s.len = end - begin;
+    s.f = &f;
+    State *state = &s;
+
+    const int helpers = std::min(chunks, size()) - 1;
+    for (int i = 0; i < helpers; i++) {
+      submit([state] {
+        state->run_chunks();
+        state->exited.fetch_add(1);
+      });
+    }
+    state->run_chunks();
+    while (state->done.load() < chunks || state->exited.load() < helpers) {
+      if (!run_one()) {
+        std::this_thread::yield();
+      }
+    }
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+  }
+
+ private:
+  /*
+   * Double-ended queue of tasks in a ring buffer that only ever grows: unlike std::deque it does not
+   * allocate and free blocks as tasks pass through, so a steady stream of tasks costs no heap traffic.
+   */
+  class TaskRing {
+   public:
+    bool empty() const {
+      return count == 0;
+    }
+    void push_back(std::function<void()> task) {
+      if (count == slots.size()) {
+        grow();
+      }
+      slots[(head + count++) % slots.size()] = std::move(task);
+    }
+    std::function<void()> pop_back() {
+      return std::move(slots[(head + --count) % slots.size()]);
+    }
+    std::function<void()> pop_front() {
+      auto task = std::move(slots[head]);
+      head = (head + 1) % slots.size();
+      count--;
+      return task;
+    }
+
+   private:
+    void grow() {
+      std::vector<std::function<void()>> bigger(std::max<size_t>(16, 2 * slots.size()));
+      for (size_t i = 0; i < count; i++) {
+        bigger[i] = std::move(slots[(head + i) % slots.size()]);
+      }
+      slots = std::move(bigger);
+      head = 0;
+    }
+
+    std::vector<std::function<void()>> slots;
+    size_t head = 0, count = 0;
+  };
+
+  struct Queue {
+    TaskRing tasks;
+    std::mutex mutex;
+  };
+
+  // Pool and queue index of the calling thread; nullptr / 0 outside of any pool.
+  static ThreadPool *&current_pool() {
+    thread_local ThreadPool *pool = nullptr;
+    return pool;
+  }
+  static int &current_index() {
+    thread_local int index = 0;
+    return index;
+  }
+
+  // Own deque from the back, then the shared queue, then steal from the front of the others.
+  bool take(std::function<void()> &task) {
+    const int self = current_pool() == this ? current_index() : 0;
+    if (self != 0 && pop(*queues[self], task, true)) {
+      return true;
+    }
+    const int count = queues.size();
+    for (int k = 0; k < count; k++) {
+      const int victim = (self + k) % count;
+      if (victim != self || self == 0) {
+        if (pop(*queues[victim], task, false)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  bool pop(Queue &q, std::function<void()> &task, bool back) {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) {
+      return false;
+    }
+    task = (back ? q.tasks.pop_back() : q.tasks.pop_front());
+    pending.fetch_sub(1);
+    return true;
+  }
+
+  void work(int index) {
+    current_pool() = this;
+    current_index() = index;
+    while (true) {
+      if (run_one()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      cv.wait(lock, [this] { return stop || pending.load() > 0; });
+      if (stop && pending.load() == 0) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<int> pending{0};
+  std::mutex sleep_mutex;
+  std::condition_variable cv;
+  bool stop = false;
+};
+
+/*
+ * Set of tasks that may be waited for together, e.g. the independent halves of a recursion:
+ *   TaskGroup g;
+ *   g.run([&] { solve(left); });
+ *   solve(right);
+ *   g.wait();
+ * wait() executes queued tasks while it waits, so groups may be nested to any depth; the rule for
+ * per-thread state of ThreadPool applies to it as well.
+ * The first exception thrown by a task is rethrown by wait().
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool &pool) : pool(pool), state(std::make_shared<State>()) {
+  }
+  TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  ~TaskGroup() {
+    try {
+      wait();
+    } catch (...) {
+    }
+  }
+
+  template<typename F>
+  void run(F &&f) {
+    state->active.fetch_add(1);
+    pool.submit([state = state, f = std::forward<F>(f)]() mutable {
+      try {
+        f();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(state->error_mutex);
+        if (!state->error) {
+          state->error = std::current_exception();
+        }
+      }
+      state->active.fetch_sub(1);
+    });
+  }
+
+  void wait() {
+    while (state->active.load() > 0) {
+      if (!pool.run_one()) {
+        std::this_thread::yield();
+      }
+    }
+    if (state->error) {
+      std::exception_ptr error = state->error;
+      state->error = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+ private:
+  struct State {
+    std::atomic<int> active{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+  };
+
+  ThreadPool &pool;
+  std::shared_ptr<State> state;
+};
+
+inline int default_num_threads() {
+  if (const char *env = std::getenv("LINEAR_NUM_THREADS")) {
+    int threads = std::atoi(env);
+    if (threads > 0) {
+      return threads;
+    }
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+inline std::unique_ptr<ThreadPool> &thread_pool_instance() {
+  static std::unique_ptr<ThreadPool> pool = std::make_unique<ThreadPool>(default_num_threads());
+  return pool;
+}
+
+/*
+ * The library-wide pool. Its size defaults to LINEAR_NUM_THREADS or the number of hardware threads.
+ */
+inline ThreadPool &thread_pool() {
+  return *thread_pool_instance();
+}
+
+// Replaces the library-wide pool. Must not be called while the pool is in use.
+inline void set_num_threads(int threads) {
+  thread_pool_instance() = std::make_unique<ThreadPool>(threads);
+}
+
+// A group on the library-wide pool.
+inline TaskGroup::TaskGroup() : TaskGroup(thread_pool()) {
+}
+
+inline int num_threads() {
+  return thread_pool().size();
+}
+
+/*
+ * parallel_for on the library pool that stays serial when `work` is below PARALLEL_THRESHOLD.
+ */
+template<typename F>
+void parallel_for(int begin, int end, long long work, F &&f) {
+  if (work < PARALLEL_THRESHOLD || end - begin <= 1) {
+    f(begin, end);
+    return;
+  }
+  const long long per_item = std::max(1LL, work / (end - begin));
+  const int grain = std::max(1LL, PARALLEL_THRESHOLD / 4 / per_item);
+  thread_pool().parallel_for(begin, end, grain, f);
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_THREAD_POOL_HPP_
@@ -0,0 +1,547 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_TILED_MATRIX_HPP_
+#define LINEAR_CORE_TILED_MATRIX_HPP_
+
+#include "aligned_allocator.hpp"
+#include "gemm.hpp"
+#include "matrix.hpp"
+#include "matrix_file.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Linear {
+
+namespace detail {
+
+// Positioned reads and writes of a file shared by several threads.
+class TileFile {
+ public:
+  TileFile(const std::string &path, bool create) {
+#ifdef LINEAR_HAS_MMAP
+    fd = ::open(path.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open matrix file!");
+    }
+#else
+    if (create) {
+      std::ofstream(path, std::ios::binary);
+    }
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file) {
+      throw std::runtime_error("Cannot open matrix file!");
+    }
+#endif
+  }
+  ~TileFile() {
+#ifdef LINEAR_HAS_MMAP
+    ::close(fd);
+#endif
+  }
+  TileFile(const TileFile &) = delete;
+  TileFile &operator=(const TileFile &) = delete;
+
+  bool read(void *buf, size_t size, uint64_t offset) {
+#ifdef LINEAR_HAS_MMAP
+    char *p = static_cast<char *>(buf);
+    while (size > 0) {
+      ssize_t got = ::pread(fd, p, size, off_t(offset));
+      if (got <= 0) {
+        return false;
+      }
+      p += got, size -= got, offset += got;
+    }
+    return true;
+#else
+    std::lock_guard<std::mutex> lock(mutex);
+    file.seekg(std::streamoff(offset));
+    file.read(static_cast<char *>(buf), std::streamsize(size));
+    return bool(file);
+#endif
+  }
+
+  bool write(const void *buf, size_t size, uint64_t offset) {
+#ifdef LINEAR_HAS_MMAP
+    const char *p = static_cast<const char *>(buf);
+    while (size > 0) {
+      ssize_t put = ::pwrite(fd, p, size, off_t(offset));
+      if (put <= 0) {
+        return false;
+      }
+      p += put, size -= put, offset += put;
+    }
+    return true;
+#else
+    std::lock_guard<std::mutex> lock(mutex);
+    file.seekp(std::streamoff(offset));
+    file.write(static_cast<const char *>(buf), std::streamsize(size));
+    return bool(file.flush());
+#endif
+  }
+
+  // Extends the file to size bytes; the new part reads as zeros.
+  bool resize(uint64_t size) {
+#ifdef LINEAR_HAS_MMAP
+    return ::ftruncate(fd, off_t(size)) == 0;
+#else
+    const char zero = 0;
+    return size == 0 || write(&zero, 1, size - 1);
+#endif
+  }
+
+ private:
+#ifdef LINEAR_HAS_MMAP
+  int fd;
+#else
+  std::fstream file;
+  std::mutex mutex;
+#endif
+};
+
+}// namespace detail
+
+/*
+ * Square matrix kept on disk in tile x tile blocks (the tiled layout of matrix_file.hpp), for matrices
+ * that do not fit in memory. At most cache_tiles tiles are held in an LRU cache; a tile is pinned while
+ * a read_tile / write_tile pointer to it is alive, and modified tiles are written back on eviction or
+ * flush(). A background thread reads tiles requested by prefetch(), so the streaming loops (matvec,
+ * tiled_gemm) compute on one tile while the next ones are read.
+ * Nothing is read twice per pass, so matvec runs at about disk bandwidth once the matrix exceeds the cache.
+ */
+template<typename T>
+class TiledMatrix {
+ public:
+  using value_type = T;
+
+  const int n;
+  const int tile;
+
+  // New zero matrix in the file at path, replacing the file.
+  static TiledMatrix create(const std::string &path, int n, int tile = 512, int cache_tiles = 64) {
+    if (n < 0 || tile <= 0) {
+      throw std::runtime_error("Bad tiled matrix size!");
+    }
+    auto h = detail::make_header(matrix_dtype<T>(), MatrixLayout::tiled, n);
+    h.ld = tile;
+    auto file = std::make_unique<detail::TileFile>(path, true);
+    if (!file->write(&h, sizeof(h), 0) || !file->resize(h.offset + tile_count(h) * tile_count(h) * tile * tile * sizeof(T))) {
+      throw std::runtime_error("Cannot write matrix file!");
+    }
+    return TiledMatrix(std::move(file), h, cache_tiles);
+  }
+
+  // Opens a matrix written by create or save_tiled_matrix, of the same dtype.
+  static TiledMatrix open(const std::string &path, int cache_tiles = 64) {
+    auto file = std::make_unique<detail::TileFile>(path, false);
+    MatrixFileHeader h;
+    if (!file->read(&h, sizeof(h), 0) || std::memcmp(h.magic, MATRIX_FILE_MAGIC, sizeof(h.magic)) != 0) {
+      throw std::runtime_error("Not a matrix file!");
+    }
+    if (h.version != MATRIX_FILE_VERSION) {
+      throw std::runtime_error("Unsupported matrix file version!");
+    }
+    if (h.layout != uint32_t(MatrixLayout::tiled) || h.dtype != uint32_t(matrix_dtype<T>()) || h.ld == 0 || h.rows != h.cols) {
+      throw std::runtime_error("Not a tiled matrix file of this type!");
+    }
+    return TiledMatrix(std::move(file), h, cache_tiles);
+  }
+
+  TiledMatrix(const TiledMatrix &) = delete;
+  TiledMatrix &operator=(const TiledMatrix &) = delete;
+
+  ~TiledMatrix() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+      error = nullptr;// nobody is left to see it; the flush below still has to run
+    }
+    io_cv.notify_all();
+    io.join();
+    try {
+      flush();
+    } catch (...) {
+    }
+  }
+
+  size_t size() const {
+    return n;
+  }
+  // Tiles per side.
+  int tiles() const {
+    return side;
+  }
+  // Rows (or columns) of the matrix in tile row ti; the last tile row may be partial.
+  int tile_rows(int ti) const {
+    return std::min(tile, n - ti * tile);
+  }
+
+  /*
+   * Tile (ti, tj) with row stride tile, pinned in the cache while the pointer lives.
+   * write_tile marks the tile modified.
+   */
+  std::shared_ptr<const T> read_tile(int ti, int tj) const {
+    return acquire(ti * side + tj, false);
+  }
+  std::shared_ptr<T> write_tile(int ti, int tj) {
+    return acquire(ti * side + tj, true);
+  }
+
+  // Asks the background thread to read tile (ti, tj) into the cache.
+  void prefetch(int ti, int tj) const {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back(ti * side + tj);
+    }
+    io_cv.notify_one();
+  }
+
+  T get(int i, int j) const {
+    return read_tile(i / tile, j / tile).get()[size_t(i % tile) * tile + j % tile];
+  }
+  void set(int i, int j, const T &x) {
+    write_tile(i / tile, j / tile).get()[size_t(i % tile) * tile + j % tile] = x;
+  }
+
+  /*
+   * Writes every modified cached tile back to the file, and only then throws a pending error of a
+   * background read or write: a failed prefetch never drops writes. A tile that cannot be written
+   * stays dirty and the others are still written.
+   */
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    bool ok = true;
+    for (auto &[id, t] : cache) {
+      if (t->loaded && t->dirty) {
+        if (file->write(t->data.data(), tile_bytes(), tile_offset(id))) {
+          t->dirty = false;
+        } else {
+          ok = false;
+        }
+      }
+    }
+    if (!ok) {
+      throw std::runtime_error("Cannot write matrix file!");
+    }
+    rethrow(lock);
+  }
+
+  // y = A * x, streaming over the tiles in file order.
+  void matvec(const T *x, T *y) const {
+    std::fill(y, y + n, T(0));
+    const int total = side * side;
+    const int depth = prefetch_depth();
+    for (int id = 0; id < std::min(depth, total); id++) {
+      prefetch(id / side, id % side);
+    }
+    for (int id = 0; id < total; id++) {
+      if (id + depth < total) {
+        prefetch((id + depth) / side, (id + depth) % side);
+      }
+      const int ti = id / side, tj = id % side;
+      const int rows = tile_rows(ti), cols = tile_rows(tj);
+      auto t = read_tile(ti, tj);
+      const T *a = t.get(), *x_j = x + tj * tile;
+      T *y_i = y + ti * tile;
+      parallel_for(0, rows, (long long) rows * cols, [&](int lo, int hi) {
+        for (int i = lo; i < hi; i++) {
+          const T *a_i = a + size_t(i) * tile;
+          T sum = 0;
+          for (int j = 0; j < cols; j++) {
+            sum += a_i[j] * x_j[j];
+          }
+          y_i[i] += sum;
+        }
+      });
+    }
+  }
+
+  std::vector<T> operator*(const std::vector<T> &x) const {
+    if (x.size() != size_t(n)) {
+      throw std::runtime_error("Matrix and vector have incompatible dimensions!");
+    }
+    std::vector<T> res(n);
+    matvec(x.data(), res.data());
+    return res;
+  }
+
+  // Tiles ahead of the current one that the streaming loops keep requested.
+  int prefetch_depth() const {
+    return std::max(1, std::min(8, capacity / 4));
+  }
+
+ private:
+  struct Tile {
+    std::vector<T, AlignedAllocator<T>> data;
+    bool loaded = false;// false while the tile is being read
+    bool failed = false;// the read failed; the tile is out of the cache and waits for its pins to go
+    bool dirty = false;
+    int pins = 0;
+    std::list<int>::iterator lru;
+  };
+
+  TiledMatrix(std::unique_ptr<detail::TileFile> file, const MatrixFileHeader &h, int cache_tiles)
+      : n(h.rows), tile(h.ld), side(tile_count(h)), capacity(std::max(cache_tiles, 2)), offset(h.offset), file(std::move(file)) {
+    io = std::thread([this] { prefetch_loop(); });
+  }
+
+  size_t tile_bytes() const {
+    return size_t(tile) * tile * sizeof(T);
+  }
+  uint64_t tile_offset(int id) const {
+    return offset + uint64_t(id) * tile_bytes();
+  }
+
+  void rethrow(std::unique_lock<std::mutex> &) const {
+    if (error) {
+      auto e = error;
+      error = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+
+  std::shared_ptr<T> acquire(int id, bool write) const {
+    std::unique_lock<std::mutex> lock(mutex);
+    rethrow(lock);
+    Tile *t = fetch(id, true, lock);
+    t->dirty |= write;
+    return std::shared_ptr<T>(t->data.data(), [this, t](T *) {
+      std::lock_guard<std::mutex> lock(mutex);
+      t->pins--;
+    });
+  }
+
+  /*
+   * Brings tile id into the cache and moves it to the front of the LRU list; the lock is released
+   * while the file is read. A pinned tile is returned loaded; prefetch (pin = false) does not wait
+   * for a tile someone else is already reading.
+   */
+  Tile *fetch(int id, bool pin, std::unique_lock<std::mutex> &lock) const {
+    cache_cv.wait(lock, [&] { return writing.count(id) == 0; });
+    auto it = cache.find(id);
+    if (it != cache.end()) {
+      Tile *t = it->second.get();
+      lru.splice(lru.begin(), lru, t->lru);
+      if (pin) {
+        t->pins++;
+        cache_cv.wait(lock, [&] { return t->loaded || t->failed; });
+        if (t->failed) {
+          unpin_failed(t);
+          throw std::runtime_error("Cannot read matrix file!");
+        }
+      }
+      return t;
+    }
+    std::unique_ptr<Tile> fresh;
+    if (!spare.empty()) {
+      fresh = std::move(spare.back());
+      spare.pop_back();
+      fresh->loaded = fresh->dirty = fresh->failed = false;
+    } else {
+      fresh = std::make_unique<Tile>();
+    }
+    Tile *t = fresh.get();
+    t->pins = 1;
+    lru.push_front(id);
+    t->lru = lru.begin();
+    cache.emplace(id, std::move(fresh));
+    lock.unlock();
+    t->data.resize(size_t(tile) * tile);
+    bool ok = file->read(t->data.data(), tile_bytes(), tile_offset(id));
+    lock.lock();
+    if (!ok) {
+      // the threads waiting for the tile still hold it, so it leaves the cache but lives until they let go
+      lru.erase(t->lru);
+      t->failed = true;
+      failed.push_back(std::move(cache.at(id)));
+      cache.erase(id);
+      unpin_failed(t);
+      cache_cv.notify_all();
+      throw std::runtime_error("Cannot read matrix file!");
+    }
+    t->loaded = true;
+    t->pins -= !pin;
+    cache_cv.notify_all();
+    try {
+      shrink(lock);
+    } catch (...) {
+      t->pins -= pin;
+      throw;
+    }
+    return t;
+  }
+
+  // Drops a pin of a tile whose read failed; the last one gives the buffer back for reuse.
+  void unpin_failed(Tile *t) const {
+    if (--t->pins == 0) {
+      auto it = std::find_if(failed.begin(), failed.end(), [&](const auto &p) { return p.get() == t; });
+      spare.push_back(std::move(*it));
+      failed.erase(it);
+    }
+  }
+
+  // Evicts least recently used unpinned tiles until the cache fits its capacity.
+  void shrink(std::unique_lock<std::mutex> &lock) const {
+    while (int(cache.size()) > capacity) {
+      auto victim = std::find_if(lru.rbegin(), lru.rend(), [&](int id) {
+        const Tile &t = *cache.at(id);
+        return t.loaded && t.pins == 0;
+      });
+      if (victim == lru.rend()) {
+        return;
+      }
+      const int id = *victim;
+      auto t = std::move(cache.at(id));
+      cache.erase(id);
+      lru.erase(t->lru);
+      if (t->dirty) {
+        Tile *w = t.get();
+        writing.emplace(id, std::move(t));
+        lock.unlock();
+        bool ok = file->write(w->data.data(), tile_bytes(), tile_offset(id));
+        lock.lock();
+        t = std::move(writing.at(id));
+        writing.erase(id);
+        cache_cv.notify_all();
+        if (!ok) {
+          // keep the only copy of the data cached
+          lru.push_back(id);
+          t->lru = std::prev(lru.end());
+          cache.emplace(id, std::move(t));
+          throw std::runtime_error("Cannot write matrix file!");
+        }
+      }
+      spare.push_back(std::move(t));
+    }
+  }
+
+  void prefetch_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      io_cv.wait(lock, [&] { return stop || !queue.empty(); });
+      if (stop) {
+        return;
+      }
+      int id = queue.front();
+      queue.pop_front();
+      try {
+        fetch(id, false, lock);
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+  }
+
+  const int side;// tiles per side
+  const int capacity;
+  const uint64_t offset;
+  std::unique_ptr<detail::TileFile> file;
+
+  mutable std::mutex mutex;
+  mutable std::condition_variable cache_cv;// a tile finished loading or writing back
+  mutable std::condition_variable io_cv;   // the prefetch queue got work
+  mutable std::unordered_map<int, std::unique_ptr<Tile>> cache;
+  mutable std::unordered_map<int, std::unique_ptr<Tile>> writing;// evicted, being written back
+  mutable std::vector<std::unique_ptr<Tile>> spare;               // evicted buffers for reuse
+  mutable std::vector<std::unique_ptr<Tile>> failed;              // failed reads, still pinned by waiters
+  mutable std::list<int> lru;                                     // most recently used first
+  mutable std::deque<int> queue;
+  mutable std::exception_ptr error;// of a background read or write, thrown by the next access
+  bool stop = false;
+  std::thread io;
+};
+
+// Writes A to the file at path in the tiled layout, for TiledMatrix<T>::open.
+template<typename T>
+void save_tiled_matrix(const std::string &path, const Matrix<T> &A, int tile = 512) {
+  auto res = TiledMatrix<T>::create(path, A.n, tile, 2);
+  for (int ti = 0; ti < res.tiles(); ti++) {
+    for (int tj = 0; tj < res.tiles(); tj++) {
+      auto t = res.write_tile(ti, tj);
+      for (int i = 0; i < res.tile_rows(ti); i++) {
+        const T *a_i = A.row_data(ti * tile + i) + tj * tile;
+        std::copy(a_i, a_i + res.tile_rows(tj), t.get() + size_t(i) * tile);
+      }
+    }
+  }
+  res.flush();
+}
+
+/*
+ * C = A * B tile by tile: each tile of C accumulates the products of a tile row of A and a tile column
+ * of B through the packed gemm, with the next pair of tiles prefetched while the current one is multiplied.
+ */
+template<typename T>
+void tiled_gemm(const TiledMatrix<T> &A, const TiledMatrix<T> &B, TiledMatrix<T> &C) {
+  if (A.n != B.n || A.n != C.n) {
+    throw std::runtime_error("Matrices have different sizes!");
+  }
+  if (A.tile != B.tile || A.tile != C.tile) {
+    throw std::runtime_error("Matrices have different tile sizes!");
+  }
+  const int tiles = A.tiles(), tile = A.tile;
+  for (int ti = 0; ti < tiles; ti++) {
+    for (int tj = 0; tj < tiles; tj++) {
+      auto c = C.write_tile(ti, tj);
+      std::fill(c.get(), c.get() + size_t(tile) * tile, T(0));
+      A.prefetch(ti, 0);
+      B.prefetch(0, tj);
+      for (int tk = 0; tk < tiles; tk++) {
+        if (tk + 1 < tiles) {
+          A.prefetch(ti, tk + 1);
+          B.prefetch(tk + 1, tj);
+        }
+        auto a = A.read_tile(ti, tk);
+        auto b = B.read_tile(tk, tj);
+        gemm(A.tile_rows(ti), A.tile_rows(tj), A.tile_rows(tk), T(1), a.get(), tile, b.get(), tile, T(1), c.get(), tile);
+      }
+    }
+  }
+}
+
+// Gershgorin circles of a tiled matrix, in one pass over the tiles.
+template<typename T>
+std::vector<std::pair<T, long double>> gershgorin_circles(const TiledMatrix<T> &A) {
+  std::vector<std::pair<T, long double>> res(A.n);
+  const int tiles = A.tiles(), tile = A.tile;
+  for (int ti = 0; ti < tiles; ti++) {
+    for (int tj = 0; tj < tiles; tj++) {
+      if (ti * tiles + tj + 1 < tiles * tiles) {
+        A.prefetch((ti * tiles + tj + 1) / tiles, (ti * tiles + tj + 1) % tiles);
+      }
+      auto t = A.read_tile(ti, tj);
+      for (int i = 0; i < A.tile_rows(ti); i++) {
+        auto &[center, radius] = res[ti * tile + i];
+        for (int j = 0; j < A.tile_rows(tj); j++) {
+          const T a_ij = t.get()[size_t(i) * tile + j];
+          if (ti * tile + i == tj * tile + j) {
+            center = a_ij;
+          } else {
+            radius += std::abs(a_ij);
+          }
+        }
+      }
+    }
+  }
+  return res;
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_TILED_MATRIX_HPP_
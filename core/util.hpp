@@ -15,32 +15,32 @@ namespace Linear {
 
 const double EPS = 1e-6;
 
-template<typename T>
-T abs(const std::vector<T> &v) {
-  T res = 0;
-  for (const T &x : v) {
-    res += std::abs(x) * std::abs(x);
+template<typename V, std::enable_if_t<is_vector_like<V>, int> = 0>
+expr_value_t<V> abs(const V &v) {
+  expr_value_t<V> res = 0;
+  for (size_t i = 0; i < v.size(); i++) {
+    res += std::abs(v[i]) * std::abs(v[i]);
   }
   return sqrt(res);
 }
 
-template<typename T>
-bool is_zero(const std::vector<T> &x) {
+template<typename V, std::enable_if_t<is_vector_like<V>, int> = 0>
+bool is_zero(const V &x) {
   return abs(x) < EPS;
 }
 
-template<typename T>
+template<typename T, std::enable_if_t<!is_vector_like<T>, int> = 0>
 bool is_zero(const T &x) {
   return std::abs(x) < EPS;
 }
 
 template<typename T1, typename T2>
-bool check_dimension(T1 a, T2 b) {
+bool check_dimension(const T1 &a, const T2 &b) {
   return a.size() == b.size();
 }
 
-template<typename T>
-std::vector<std::pair<T, long double>> gershgorin_circles(const Matrix<T> &A) {
+template<typename T, int N>
+std::vector<std::pair<T, long double>> gershgorin_circles(const Matrix<T, N> &A) {
   std::vector<std::pair<T, long double>> res(A.n);
   for (int i = 0; i < A.n; i++) {
     long double radius = 0;
@@ -61,78 +61,6 @@ std::vector<T> random_vector(int n) {
   return x0;
 }
 
-template<typename T>
-std::vector<T> operator +(const std::vector<T> &a, const std::vector<T> &b) {
-  if (!check_dimension(a, b)) {
-    throw std::runtime_error("Vectors have different dimensions!");
-  }
-  std::vector<T> res = a;
-  for (int i = 0; i < a.size(); i++) {
-    res[i] += b[i];
-  }
-  return res;
-}
-
-template<typename T>
-std::vector<T> operator +=(std::vector<T> &a, const std::vector<T> &b) {
-  if (!check_dimension(a, b)) {
-    throw std::runtime_error("Vectors have different dimensions!");
-  }
-  a = a + b;
-  return a;
-}
-
-template<typename T>
-std::vector<T> operator -(const std::vector<T> &a, const std::vector<T> &b) {
-  if (!check_dimension(a, b)) {
-    throw std::runtime_error("Vectors have different dimensions!");
-  }
-  std::vector<T> res = a;
-  for (int i = 0; i < a.size(); i++) {
-    res[i] -= b[i];
-  }
-  return res;
-}
-
-template<typename T>
-std::vector<T> operator -=(std::vector<T> &a, const std::vector<T> &b) {
-  if (!check_dimension(a, b)) {
-    throw std::runtime_error("Vectors have different dimensions!");
-  }
-  a = a - b;
-  return a;
-}
-
-template<typename T>
-std::vector<T> operator *(const std::vector<T> &a, const T &k) {
-  std::vector<T> res = a;
-  for (int i = 0; i < a.size(); i++) {
-    res[i] *= k;
-  }
-  return res;
-}
-
-template<typename T>
-std::vector<T> operator /(const std::vector<T> &a, const T &k) {
-  std::vector<T> res = a;
-  for (int i = 0; i < a.size(); i++) {
-    res[i] /= k;
-  }
-  return res;
-}
-
-template<typename T>
-std::vector<T> operator -(const std::vector<T> &a) {
-  return a * T(-1);
-}
-
-template<typename T>
-std::vector<T> operator *=(const std::vector<T> &a, const T &k) {
-  a = a * k;
-  return a;
-}
-
-
 template<class T>
 std::ostream &operator<<(std::ostream &out, const std::vector<T> &m) {
   for (auto &i : m) {
@@ -142,27 +70,30 @@ std::ostream &operator<<(std::ostream &out, const std::vector<T> &m) {
   return out;
 }
 
-template<typename T = double>
-Matrix<T> identity(int n) {
-  Matrix<T> res(n);
+template<class E, class T>
+std::ostream &operator<<(std::ostream &out, const VecExpr<E, T> &m) {
+  return out << m.eval();
+}
+
+template<typename T = double, int N = DYNAMIC>
+Matrix<T, N> identity(int n = N) {
+  Matrix<T, N> res(n);
   for (int i = 0; i < n; i++) {
     res[i][i] = 1;
   }
   return res;
 }
 
-template<typename T>
-Matrix<T> mult(const std::vector<T> &a, const std::vector<T> &b) {
+template<typename V1, typename V2>
+Matrix<expr_value_t<V1>> mult(const V1 &a, const V2 &b) {
   if (!check_dimension(a, b)) {
     throw std::runtime_error("Bad dimensions!");
   }
   int n = a.size();
-  Matrix<T> res(n);
-  for (int i = 0; i < n; i++) {
-    for (int j = 0; j < n; j++) {
-      res[i][j] = a[i] * b[j];
-    }
-  }
+  const auto &x = evaluate(a);
+  const auto &y = evaluate(b);
+  Matrix<expr_value_t<V1>> res(n);
+  mat_for_each(n, [&](int i, int j) { res.at(i, j) = x[i] * y[j]; });
   return res;
 }
 
@@ -173,21 +104,34 @@ std::vector<T> standart(int n, int i) {
   return v;
 }
 
-template<typename T>
-const std::vector<T> normalize(const std::vector<T> &v) {
-  if (is_zero(v)) {
-    return std::vector<T>(v.size());
+template<typename V, std::enable_if_t<is_vector_like<V>, int> = 0>
+std::vector<expr_value_t<V>> normalize(V &&v) {
+  using T = expr_value_t<V>;
+  if constexpr (is_temporary<V>) {
+    T len = abs(v);
+    if (len < EPS) {
+      std::fill(v.begin(), v.end(), T(0));
+    } else {
+      for (auto &x : v) {
+        x /= len;
+      }
+    }
+    return std::move(v);
+  } else {
+    if (is_zero(v)) {
+      return std::vector<T>(v.size());
+    }
+    return v / abs(v);
   }
-  return v / abs(v);
 }
 
-template<typename T>
-const T scalar(const std::vector<T> &v1, const std::vector<T> &v2) {
+template<typename V1, typename V2>
+expr_value_t<V1> scalar(const V1 &v1, const V2 &v2) {
   if (!check_dimension(v1, v2))  {
     throw std::runtime_error("Bad dimensions!");
   }
-  T sum = 0;
-  for (int i = 0; i < v1.size(); i++) {
+  expr_value_t<V1> sum = 0;
+  for (size_t i = 0; i < v1.size(); i++) {
     sum += v1[i] * v2[i];
   }
   return sum;
@@ -5,12 +5,102 @@
 #ifndef LINEAR_CORE_VEC_HPP_
 #define LINEAR_CORE_VEC_HPP_
 
+#include "expression.hpp"
+
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 namespace Linear {
 
-template<typename T>
+/*
+ * Vector of the compile-time size N in a std::array: no heap allocation, and loops over it have a
+ * constant trip count that the compiler unrolls. Vec<T> (N = DYNAMIC) is the run-time sized one.
+ */
+template<typename T, int N = DYNAMIC>
 struct Vec {
+  static_assert(N > 0, "Vec size must be positive");
+  using value_type = T;
+  static constexpr int n = N;
+
+  std::array<T, N> v{};
+
+  constexpr Vec() = default;
+  // For code written for both forms; the size must be N.
+  explicit Vec(int size) {
+    if (size != N) {
+      throw std::runtime_error("Bad vector size!");
+    }
+  }
+  constexpr Vec(std::initializer_list<T> lst) {
+    if (lst.size() != N) {
+      throw std::runtime_error("Bad initializer!");
+    }
+    std::copy(lst.begin(), lst.end(), v.begin());
+  }
+
+  constexpr T &operator[](int i) {
+    return v[i];
+  }
+  constexpr const T &operator[](int i) const {
+    return v[i];
+  }
+  constexpr T *data() {
+    return v.data();
+  }
+  constexpr const T *data() const {
+    return v.data();
+  }
+  constexpr T *begin() {
+    return v.data();
+  }
+  constexpr T *end() {
+    return v.data() + N;
+  }
+  constexpr const T *begin() const {
+    return v.data();
+  }
+  constexpr const T *end() const {
+    return v.data() + N;
+  }
+  constexpr size_t size() const {
+    return N;
+  }
+
+  operator std::vector<T>() const {
+    return std::vector<T>(v.begin(), v.end());
+  }
+
+  constexpr Vec &operator+=(const Vec &other) {
+    for (int i = 0; i < N; i++) {
+      v[i] += other.v[i];
+    }
+    return *this;
+  }
+  constexpr Vec &operator-=(const Vec &other) {
+    for (int i = 0; i < N; i++) {
+      v[i] -= other.v[i];
+    }
+    return *this;
+  }
+  constexpr Vec &operator*=(const T &k) {
+    for (int i = 0; i < N; i++) {
+      v[i] *= k;
+    }
+    return *this;
+  }
+
+  constexpr bool operator==(const Vec &other) const {
+    return v == other.v;
+  }
+};
+
+template<typename T>
+struct Vec<T, DYNAMIC> {
   int n;
   std::vector<T> v;
   Vec(int n) : n(n) {
@@ -21,5 +111,109 @@ struct Vec {
   }
 };
 
+template<typename T, int N>
+constexpr Vec<T, N> operator+(Vec<T, N> a, const Vec<T, N> &b) {
+  return a += b;
+}
+
+template<typename T, int N>
+constexpr Vec<T, N> operator-(Vec<T, N> a, const Vec<T, N> &b) {
+  return a -= b;
+}
+
+template<typename T, int N>
+constexpr Vec<T, N> operator-(Vec<T, N> a) {
+  return a *= T(-1);
+}
+
+template<typename T, int N>
+constexpr Vec<T, N> operator*(Vec<T, N> a, const T &k) {
+  return a *= k;
+}
+
+template<typename T, int N>
+constexpr Vec<T, N> operator*(const T &k, Vec<T, N> a) {
+  return a *= k;
+}
+
+template<typename T, int N>
+constexpr T scalar(const Vec<T, N> &a, const Vec<T, N> &b) {
+  T sum = 0;
+  for (int i = 0; i < N; i++) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+template<typename T, int N>
+T abs(const Vec<T, N> &a) {
+  return std::sqrt(scalar(a, a));
+}
+
+template<typename T, int N>
+std::ostream &operator<<(std::ostream &out, const Vec<T, N> &a) {
+  for (auto &x : a) {
+    out << x << " ";
+  }
+  out << "\n";
+  return out;
+}
+
+// The vector type that goes with Matrix<T, N>: std::vector<T> for DYNAMIC, Vec<T, N> otherwise.
+template<typename T, int N>
+using vec_t = std::conditional_t<N == DYNAMIC, std::vector<T>, Vec<T, N>>;
+
+/*
+ * At most Capacity elements in place, for lists whose length is bounded at compile time
+ * (e.g. the rotations of a fixed-size QR). push_back beyond the capacity throws.
+ */
+template<typename T, size_t Capacity>
+struct StaticVector {
+  std::array<T, Capacity> items{};
+  size_t count = 0;
+
+  void push_back(const T &x) {
+    if (count == Capacity) {
+      throw std::runtime_error("StaticVector is full!");
+    }
+    items[count++] = x;
+  }
+  void clear() {
+    count = 0;
+  }
+
+  T &operator[](size_t i) {
+    return items[i];
+  }
+  const T &operator[](size_t i) const {
+    return items[i];
+  }
+  size_t size() const {
+    return count;
+  }
+  bool empty() const {
+    return count == 0;
+  }
+
+  T *begin() {
+    return items.data();
+  }
+  T *end() {
+    return items.data() + count;
+  }
+  const T *begin() const {
+    return items.data();
+  }
+  const T *end() const {
+    return items.data() + count;
+  }
+  std::reverse_iterator<const T *> rbegin() const {
+    return std::reverse_iterator<const T *>(end());
+  }
+  std::reverse_iterator<const T *> rend() const {
+    return std::reverse_iterator<const T *>(begin());
+  }
+};
+
 }
 #endif//LINEAR_CORE_VEC_HPP_
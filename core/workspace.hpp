@@ -0,0 +1,198 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_CORE_WORKSPACE_HPP_
+#define LINEAR_CORE_WORKSPACE_HPP_
+
+#include "aligned_allocator.hpp"
+#include "matrix.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Linear {
+
+/*
+ * Pool of scratch memory that solvers recycle across iterations and calls. Blocks come in size classes
+ * of a power of two times a cache line and are cache line aligned; a released block goes onto the free
+ * list of its class and serves the next request of that class. Once a solver has been through an
+ * iteration, its later iterations, and later calls of the same size, find every block on the free lists.
+ * Not thread-safe: one workspace per thread. Everything taken from a workspace must be given back
+ * before it is destroyed.
+ */
+class Workspace {
+ public:
+  Workspace() = default;
+  Workspace(const Workspace &) = delete;
+  Workspace &operator=(const Workspace &) = delete;
+  ~Workspace() {
+    trim();
+  }
+
+  // At least `bytes` bytes, cache line aligned.
+  void *acquire(size_t bytes) {
+    const int k = size_class(bytes);
+    const size_t size = CACHE_LINE << k;
+    in_use += size;
+    peak = std::max(peak, in_use);
+    if (FreeBlock *block = free_lists[k]) {
+      free_lists[k] = block->next;
+      return block;
+    }
+    void *p = ::operator new(size, std::align_val_t(CACHE_LINE));
+    reserved += size;
+    allocations++;
+    return p;
+  }
+
+  // Gives back a block acquired with the same `bytes`.
+  void release(void *p, size_t bytes) noexcept {
+    if (!p) {
+      return;
+    }
+    const int k = size_class(bytes);
+    in_use -= CACHE_LINE << k;
+    free_lists[k] = new(p) FreeBlock{free_lists[k]};
+  }
+
+  // Returns the free blocks to the heap; the ones in use stay with their owners.
+  void trim() noexcept {
+    for (int k = 0; k < CLASSES; k++) {
+      while (FreeBlock *block = free_lists[k]) {
+        free_lists[k] = block->next;
+        ::operator delete(block, std::align_val_t(CACHE_LINE));
+        reserved -= CACHE_LINE << k;
+      }
+    }
+  }
+
+  /*
+   * n x n matrix, not initialized, viewing a block of the workspace that goes back to it when
+   * the last move of the matrix is destroyed. Copies of it are ordinary matrices.
+   */
+  template<class T>
+  Matrix<T> matrix(int n);
+
+  // The most bytes in use at once since construction or reset_peak().
+  size_t peak_bytes() const {
+    return peak;
+  }
+  size_t bytes_in_use() const {
+    return in_use;
+  }
+  // Bytes held from the heap: in use plus on the free lists.
+  size_t reserved_bytes() const {
+    return reserved;
+  }
+  // Blocks taken from the heap so far; stays put while the free lists serve every request.
+  size_t heap_allocations() const {
+    return allocations;
+  }
+  void reset_peak() {
+    peak = in_use;
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+  static const int CLASSES = 48;
+
+  static int size_class(size_t bytes) {
+    int k = 0;
+    while ((CACHE_LINE << k) < bytes) {
+      if (++k == CLASSES) {
+        throw std::bad_alloc();
+      }
+    }
+    return k;
+  }
+
+  std::array<FreeBlock *, CLASSES> free_lists{};
+  size_t in_use = 0, peak = 0, reserved = 0, allocations = 0;
+};
+
+/*
+ * Allocator for standard containers that takes its memory from a workspace, or from the heap when
+ * it has none. The workspace follows the container on copy, move and swap.
+ */
+template<class U>
+struct WorkspaceAllocator {
+  using value_type = U;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  Workspace *workspace;
+
+  WorkspaceAllocator(Workspace *workspace = nullptr) noexcept : workspace(workspace) {
+  }
+  template<class V>
+  WorkspaceAllocator(const WorkspaceAllocator<V> &other) noexcept : workspace(other.workspace) {
+  }
+
+  U *allocate(size_t n) {
+    if (workspace) {
+      return static_cast<U *>(workspace->acquire(n * sizeof(U)));
+    }
+    return static_cast<U *>(::operator new(n * sizeof(U)));
+  }
+  void deallocate(U *p, size_t n) noexcept {
+    if (workspace) {
+      workspace->release(p, n * sizeof(U));
+    } else {
+      ::operator delete(p);
+    }
+  }
+
+  template<class V>
+  bool operator==(const WorkspaceAllocator<V> &other) const noexcept {
+    return workspace == other.workspace;
+  }
+  template<class V>
+  bool operator!=(const WorkspaceAllocator<V> &other) const noexcept {
+    return workspace != other.workspace;
+  }
+};
+
+template<class T>
+Matrix<T> Workspace::matrix(int n) {
+  const int ld = aligned_stride<T>(n);
+  const size_t bytes = std::max<size_t>(size_t(n) * ld, 1) * sizeof(T);
+  T *p = static_cast<T *>(acquire(bytes));
+  // the control block of the shared_ptr comes from the workspace too
+  std::shared_ptr<T> buffer(p, [this, bytes](T *q) { release(q, bytes); }, WorkspaceAllocator<T>(this));
+  return Matrix<T>(n, ld, std::move(buffer));
+}
+
+/*
+ * Scratch matrices of a solver: from the workspace if there is one, ordinary matrices otherwise.
+ * A fixed-size Matrix<T, N> never touches the heap, so for it the workspace is ignored.
+ */
+template<class T, int N = DYNAMIC>
+Matrix<T, N> scratch_matrix(Workspace *workspace, int n) {
+  if constexpr (N == DYNAMIC) {
+    if (workspace) {
+      return workspace->matrix<T>(n);
+    }
+  }
+  return Matrix<T, N>(n);
+}
+
+template<class T, int N>
+Matrix<T, N> scratch_copy(Workspace *workspace, const Matrix<T, N> &A) {
+  Matrix<T, N> res = scratch_matrix<T, N>(workspace, A.n);
+  for (int i = 0; i < A.n; i++) {
+    std::copy(A.row_data(i), A.row_data(i) + A.n, res.row_data(i));
+  }
+  return res;
+}
+
+}// namespace Linear
+
+#endif//LINEAR_CORE_WORKSPACE_HPP_
@@ -1,13 +1,19 @@
 #include "core/matrix.hpp"
+#include "core/matrix_batch.hpp"
+#include "core/matrix_file.hpp"
+#include "core/sparse_matrix.hpp"
+#include <chrono>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 
+#include "methods/batched.hpp"
 #include "methods/eigen_qr.hpp"
 #include "methods/eigen_qr_shifts.hpp"
 #include "methods/eigen_simple_iteration.hpp"
 #include "methods/givens.hpp"
 #include "methods/householder.hpp"
+#include "methods/lanczos.hpp"
 #include "methods/seidel.hpp"
 #include "methods/simple_iteration.hpp"
 #include "methods/tridiagonalization.hpp"
@@ -62,7 +68,7 @@ void task2() {
  */
 
 void task3() {
-  Matrix A({{6., 5., 0.},
+  Matrix<double, 3> A({{6., 5., 0.},
             {5., 1., 4.},
             {0., 4., 3.}});
   GivensMatrix G(0, 1, 6, 5);
@@ -74,7 +80,7 @@ void task3() {
  */
 
 void task4_1() {
-  Matrix A({{6., 5., 0.},
+  Matrix<double, 3> A({{6., 5., 0.},
             {5., 1., 4.},
             {0., 4., 3.}});
   auto res = QR_givens(A);
@@ -120,7 +126,7 @@ void task5() {
  */
 
 void task6_1() {
-  Matrix A({{6., 5., 0.},
+  Matrix<double, 3> A({{6., 5., 0.},
             {5., 1., 4.},
             {0., 4., 3.}});
   auto res = QR_householder(A);
@@ -164,7 +170,7 @@ void task7() {
  */
 
 void task8() {
-  Matrix A({{1., 3, 3, 7},
+  Matrix<double, 4> A({{1., 3, 3, 7},
             {3, 4, 0, 9},
             {3, 0, 0, 6},
             {7, 9, 6, 9}});
@@ -275,15 +281,12 @@ void task12_1() {
     G2[pu][pv] = G2[pv][pu] = 1;
   }
 
-  vector eig_values1 = eigen_qr_shift(tridiagonalization(G1).first).value().first;
-  sort(eig_values1.begin(), eig_values1.end());
-
-  vector eig_values2 = eigen_qr_shift(tridiagonalization(G2).first).value().first;
-  sort(eig_values2.begin(), eig_values2.end());
+  // both spectra in one batched call, each sorted ascending
+  vector eig_values = eigen_values_batched(MatrixBatch<double>({G1, G2})).value();
 
   bool possible_isomorphic = 1;
   for (int i = 0; i < n; i++) {
-    possible_isomorphic &= is_zero(eig_values1[i] - eig_values2[i]);
+    possible_isomorphic &= is_zero(eig_values[i] - eig_values[n + i]);
   }
 
   cout << (possible_isomorphic ? "maybe" : "not") << "\n";
@@ -303,15 +306,12 @@ void task12_2() {
     G2[u - 1][v - 1] = G2[v - 1][u - 1] = 1;
   }
 
-  vector eig_values1 = eigen_qr_shift(tridiagonalization(G1).first).value().first;
-  sort(eig_values1.begin(), eig_values1.end());
-
-  vector eig_values2 = eigen_qr_shift(tridiagonalization(G2).first).value().first;
-  sort(eig_values2.begin(), eig_values2.end());
+  // both spectra in one batched call, each sorted ascending
+  vector eig_values = eigen_values_batched(MatrixBatch<double>({G1, G2})).value();
 
   bool possible_isomorphic = 1;
   for (int i = 0; i < n; i++) {
-    possible_isomorphic &= is_zero(eig_values1[i] - eig_values2[i]);
+    possible_isomorphic &= is_zero(eig_values[i] - eig_values[n + i]);
   }
 
   cout << (possible_isomorphic ? "maybe" : "not") << "\n";
@@ -319,20 +319,20 @@ void task12_2() {
 
 void task12_0() {
   Matrix A({{0, 1.0}, {1.0, 0.0}});
-  auto res = eigen_qr_shift(A);
+  auto res = eigen_qr_shift(A, 1);
   cout << res.value().first << " " << res.value().second << "\n";
 }
 
 
 void task13_1(int n) {
-  Matrix<double> G(n * n);
+  SparseMatrixBuilder<double> G(n * n);
 
   auto add = [&n, &G](int x, int y, int x2, int y2) {
     x = (x % n + n) % n;
-    x2 = (x % n + n) % n;
+    x2 = (x2 % n + n) % n;
     y = (y % n + n) % n;
     y2 = (y2 % n + n) % n;
-    G[x * n + y][x2 * n + y2]++;
+    G.add(x * n + y, x2 * n + y2);
   };
 
 
@@ -349,40 +349,73 @@ void task13_1(int n) {
     }
   }
 
-  vector eig_values = eigen_qr_shift(tridiagonalization(G).first, 0).value().first;
-  sort(eig_values.rbegin(), eig_values.rend());
-  cout << "eigen values:\n" << eig_values << "\n";
+  // only the largest, the second largest and the smallest eigenvalues are needed
+  auto eig = lanczos(G.build(), 3, Spectrum::both_ends).value().first;
+  double second = eig[1], smallest = eig[0];
+  cout << "second largest eigen value = " << second << ", smallest eigen value = " << smallest << "\n";
 
-  cout << "alpha = " << std::max(std::abs(eig_values[1]), std::abs(eig_values.back())) / 8 << "\n";
+  cout << "alpha = " << std::max(std::abs(second), std::abs(smallest)) / 8 << "\n";
 }
 
 void task13_2(int p) { // p should be prime-number
-  Matrix<double> G(p + 1);
+  SparseMatrixBuilder<double> builder(p + 1);
   for (int i = 0; i < p; i++) {
     if (i > 0) {
       for (int j = 0; j < p; j++) {
         if (i * j % p == 1) {
-          G[i][j]++;
+          builder.add(i, j);
           break;
         }
       }
     } else {
-      G[i][p]++;
+      builder.add(i, p);
+    }
+    builder.add(i, (i + 1) % p);
+    builder.add(i, (i - 1 + p) % p);
+  }
+  builder.add(p, 0);
+  builder.add(p, p, 2);
+  SparseMatrix<double> G = builder.build();
+  save_matrix("matrix", G);
+
+  auto eig = lanczos(G, 3, Spectrum::both_ends).value().first;
+  double second = eig[1], smallest = eig[0];
+  cout << "second largest eigen value = " << second << ", smallest eigen value = " << smallest << "\n";
+
+  cout << "alpha = " << std::max(std::abs(second), std::abs(smallest)) / 3 << "\n";
+}
+
+/*
+ * Blocked GEMM: check against the plain triple loop and measure throughput.
+ */
+
+template<typename T>
+void task14(int n) {
+  mt19937 rnd(239);
+  uniform_real_distribution<T> dist(-1, 1);
+  Matrix<T> A(n), B(n);
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      A[i][j] = dist(rnd);
+      B[i][j] = dist(rnd);
     }
-    G[i][(i + 1) % p]++;
-    G[i][(i - 1 + p) % p]++;
   }
-  G[p][0] = 1;
-  G[p][p] = 2;
-  ofstream f_out;
-  f_out.open("matrix");
-  f_out << G;
 
-  vector eig_values = eigen_qr_shift(tridiagonalization(G).first).value().first;
-  sort(eig_values.rbegin(), eig_values.rend());
-  cout << "eigen values:\n" << eig_values << "\n";
+  Matrix<T> C_ref(n);
+  gemm_reference(n, n, n, T(1), A.data(), A.stride(), B.data(), B.stride(), T(0), C_ref.data(), C_ref.stride());
+
+  auto start = chrono::steady_clock::now();
+  Matrix<T> C = A * B;
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-  cout << "alpha = " << std::max(std::abs(eig_values[1]), std::abs(eig_values.back())) / 3 << "\n";
+  T error = 0;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      error = max(error, std::abs(C[i][j] - C_ref[i][j]));
+    }
+  }
+  cout << "n = " << n << ", max |C - C_ref| = " << error
+       << ", " << 2.0 * n * n * n / seconds * 1e-9 << " GFLOP/s\n";
 }
 
 int main() {
@@ -406,9 +439,12 @@ int main() {
 //  task12_2();
 //  task12_0();
 
-//  task13_1(10); // takes about 5 seconds for n = 10 and about 20 secs for n = 15
-//  task13_1(15);
-//  task13_1(20); // on my PC it took 3 minutes
+//  task13_1(20);
+//  task13_1(100);
+//  task13_1(300); // 90000 vertices, about 2 seconds
+
+//  task14<double>(1000);
+//  task14<float>(1000);
   task13_2(239);
 
   return 0;
@@ -0,0 +1,353 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_METHODS_BATCHED_HPP_
+#define LINEAR_METHODS_BATCHED_HPP_
+
+#include "../core/matrix_batch.hpp"
+#include "../core/thread_pool.hpp"
+#include "eigen_qr_shifts.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+
+namespace Linear {
+
+extern const int LIMIT;
+
+/*
+ * Batched versions of the dense routines for many small matrices of one size (MatrixBatch).
+ * Every kernel works on a group of LANES matrices in lockstep, the loops over the lanes being
+ * innermost so that they vectorize; groups are spread across the thread pool. The scratch space
+ * is allocated once per chunk of groups, not per matrix.
+ */
+
+/*
+ * make_reflector for the LANES interleaved vectors x[i * stride + l], i < m, lane by lane
+ * (without its rescaling): x[0] gets beta, x[i] the entries of v, tau[l] the factor of lane l.
+ */
+template<typename T>
+void make_reflectors(int m, T *x, size_t stride, T *tau) {
+  constexpr int L = MatrixBatch<T>::LANES;
+  T alpha[L], sigma[L] = {}, inv[L];
+  for (int l = 0; l < L; l++) {
+    alpha[l] = x[l];
+  }
+  for (int i = 1; i < m; i++) {
+    const T *x_i = x + i * stride;
+    for (int l = 0; l < L; l++) {
+      sigma[l] += x_i[l] * x_i[l];
+    }
+  }
+  for (int l = 0; l < L; l++) {
+    const bool skip = (sigma[l] == 0 && alpha[l] >= 0);
+    const T beta = std::sqrt(alpha[l] * alpha[l] + sigma[l]);
+    T v0 = (alpha[l] <= 0 ? alpha[l] - beta : -sigma[l] / (alpha[l] + beta));
+    v0 = (skip ? T(1) : v0);
+    tau[l] = (skip ? T(0) : 2 * v0 * v0 / (v0 * v0 + sigma[l]));
+    inv[l] = 1 / v0;
+    x[l] = (skip ? alpha[l] : beta);
+  }
+  for (int i = 1; i < m; i++) {
+    T *x_i = x + i * stride;
+    for (int l = 0; l < L; l++) {
+      x_i[l] *= inv[l];
+    }
+  }
+}
+
+/*
+ * W = H * W on rows [r0, r0 + m) and columns [c0, c1) of a group of n x n matrices, lane by lane,
+ * with H = I - tau * v * v^T and v = (1, v[stride], v[2 * stride], ...). buf: (c1 - c0) * LANES scratch values.
+ */
+template<typename T>
+void apply_reflectors(int n, int m, const T *v, size_t stride, const T *tau, T *W, int r0, int c0, int c1, T *buf) {
+  constexpr int L = MatrixBatch<T>::LANES;
+  const int width = (c1 - c0) * L;
+  auto row = [&](int i) { return W + (size_t(r0 + i) * n + c0) * L; };
+  std::copy(row(0), row(0) + width, buf);
+  for (int i = 1; i < m; i++) {
+    const T *v_i = v + i * stride, *w_i = row(i);
+    for (int j = 0; j < width; j += L) {
+      for (int l = 0; l < L; l++) {
+        buf[j + l] += v_i[l] * w_i[j + l];
+      }
+    }
+  }
+  for (int j = 0; j < width; j += L) {
+    for (int l = 0; l < L; l++) {
+      buf[j + l] *= tau[l];
+    }
+  }
+  for (int i = 0; i < m; i++) {
+    T *w_i = row(i);
+    for (int j = 0; j < width; j += L) {
+      for (int l = 0; l < L; l++) {
+        w_i[j + l] -= (i == 0 ? buf[j + l] : v[i * stride + l] * buf[j + l]);
+      }
+    }
+  }
+}
+
+// Sets a group of n x n matrices to the identity.
+template<typename T>
+void set_identity(int n, T *W) {
+  constexpr int L = MatrixBatch<T>::LANES;
+  std::fill(W, W + size_t(n) * n * L, T(0));
+  for (int i = 0; i < n; i++) {
+    std::fill(W + (size_t(i) * n + i) * L, W + (size_t(i) * n + i + 1) * L, T(1));
+  }
+}
+
+/*
+ * A_k = Q_k * A'_k * Q_k^T with A'_k tridiagonal for every symmetric A_k of the batch, by Householder
+ * reflections as in tridiagonalization. Returns {A', Q}; Q is an empty batch unless needQ.
+ */
+template<typename T>
+std::pair<SymTridiagonalBatch<T>, MatrixBatch<T>> tridiagonalization_batched(const MatrixBatch<T> &A, bool needQ = 0) {
+  constexpr int L = MatrixBatch<T>::LANES;
+  const int n = A.n;
+  SymTridiagonalBatch<T> res(n, A.count);
+  MatrixBatch<T> Q(n, needQ ? A.count : 0);
+  const size_t stride = size_t(n) * L;
+  parallel_for(0, A.groups(), (long long) A.groups() * n * n * n * L, [&](int lo, int hi) {
+    std::vector<T> W(size_t(n) * n * L), tau(n * L), v(n * L), p(n * L), buf(n * L);
+    for (int g = lo; g < hi; g++) {
+      std::copy(A.group(g), A.group(g) + W.size(), W.begin());
+      for (int k = 0; k + 2 < n; k++) {
+        // the reflector for column k below the subdiagonal, v stored in its place
+        const int b = k + 1, m = n - b;
+        T *x = W.data() + (size_t(b) * n + k) * L;
+        T *t = tau.data() + k * L;
+        make_reflectors(m, x, stride, t);
+        for (int l = 0; l < L; l++) {
+          v[l] = 1;
+        }
+        for (int i = 1; i < m; i++) {
+          std::copy(x + i * stride, x + i * stride + L, v.begin() + i * L);
+        }
+        // two-sided update of the trailing block: A -= v * w^T + w * v^T,
+        // p = tau * A * v, w = p - (tau / 2) * (p^T * v) * v
+        T K[L] = {};
+        for (int i = 0; i < m; i++) {
+          const T *a_i = W.data() + (size_t(b + i) * n + b) * L;
+          T acc[L] = {};
+          for (int j = 0; j < m; j++) {
+            for (int l = 0; l < L; l++) {
+              acc[l] += a_i[j * L + l] * v[j * L + l];
+            }
+          }
+          for (int l = 0; l < L; l++) {
+            p[i * L + l] = t[l] * acc[l];
+            K[l] += p[i * L + l] * v[i * L + l];
+          }
+        }
+        for (int l = 0; l < L; l++) {
+          K[l] *= t[l] / 2;
+        }
+        for (int i = 0; i < m; i++) {
+          for (int l = 0; l < L; l++) {
+            p[i * L + l] -= K[l] * v[i * L + l];
+          }
+        }
+        for (int i = 0; i < m; i++) {
+          T *a_i = W.data() + (size_t(b + i) * n + b) * L;
+          for (int j = 0; j < m; j++) {
+            for (int l = 0; l < L; l++) {
+              a_i[j * L + l] -= v[i * L + l] * p[j * L + l] + p[i * L + l] * v[j * L + l];
+            }
+          }
+        }
+      }
+      T *d = res.diagonal(g), *e = res.off_diagonal(g);
+      for (int i = 0; i < n; i++) {
+        std::copy(W.begin() + (size_t(i) * n + i) * L, W.begin() + (size_t(i) * n + i + 1) * L, d + i * L);
+      }
+      for (int i = 0; i + 1 < n; i++) {
+        std::copy(W.begin() + (size_t(i + 1) * n + i) * L, W.begin() + (size_t(i + 1) * n + i + 1) * L, e + i * L);
+      }
+      if (needQ) {
+        // Q = H_0 * ... * H_{n-3}, accumulated backwards
+        T *q = Q.group(g);
+        set_identity(n, q);
+        for (int k = n - 3; k >= 0; k--) {
+          apply_reflectors(n, n - k - 1, W.data() + (size_t(k + 1) * n + k) * L, stride, tau.data() + k * L, q,
+                           k + 1, k + 1, n, buf.data());
+        }
+      }
+    }
+  });
+  return {res, Q};
+}
+
+/*
+ * A_k = Q_k * R_k for every matrix of the batch by Householder reflections (R_k with nonnegative
+ * diagonal, as QR_householder). Returns {Q, R}.
+ */
+template<typename T>
+std::pair<MatrixBatch<T>, MatrixBatch<T>> QR_householder_batched(const MatrixBatch<T> &A) {
+  constexpr int L = MatrixBatch<T>::LANES;
+  const int n = A.n;
+  MatrixBatch<T> Q(n, A.count), R(n, A.count);
+  const size_t stride = size_t(n) * L;
+  parallel_for(0, A.groups(), (long long) A.groups() * n * n * n * L, [&](int lo, int hi) {
+    std::vector<T> W(size_t(n) * n * L), tau(n * L), buf(n * L);
+    for (int g = lo; g < hi; g++) {
+      std::copy(A.group(g), A.group(g) + W.size(), W.begin());
+      for (int k = 0; k < n; k++) {
+        T *x = W.data() + (size_t(k) * n + k) * L;
+        make_reflectors(n - k, x, stride, tau.data() + k * L);
+        apply_reflectors(n, n - k, x, stride, tau.data() + k * L, W.data(), k, k + 1, n, buf.data());
+      }
+      T *r = R.group(g), *q = Q.group(g);
+      for (int i = 0; i < n; i++) {
+        std::copy(W.begin() + (size_t(i) * n + i) * L, W.begin() + size_t(i + 1) * n * L, r + (size_t(i) * n + i) * L);
+      }
+      set_identity(n, q);
+      for (int k = n - 1; k >= 0; k--) {
+        apply_reflectors(n, n - k, W.data() + (size_t(k) * n + k) * L, stride, tau.data() + k * L, q, k, k, n,
+                         buf.data());
+      }
+    }
+  });
+  return {Q, R};
+}
+
+/*
+ * Eigenvalues (and, if needQ, eigenvectors: A_k = Z_k * diag * Z_k^T) of every matrix of a tridiagonal
+ * batch by implicit shifted QR as in eigen_qr_shift. Each lane deflates on its own and chases the bulge
+ * of its own unreduced block; a sweep runs over the union of the blocks and is the identity on the
+ * lanes outside theirs. The eigenvalues of matrix k are values[k * n .. (k + 1) * n) in ascending order,
+ * the eigenvectors the columns of Z_k in the same order (Z is an empty batch unless needQ).
+ * Returns nullopt if some eigenvalue takes more than LIMIT steps.
+ */
+template<typename T>
+std::optional<std::pair<std::vector<T>, MatrixBatch<T>>>
+eigen_qr_shift_batched(const SymTridiagonalBatch<T> &A, bool needQ = 0, const double EPS = 1e-3) {
+  constexpr int L = MatrixBatch<T>::LANES;
+  const int n = A.n;
+  std::vector<T> values(size_t(n) * A.count);
+  MatrixBatch<T> Z(n, needQ ? A.count : 0);
+  std::atomic<bool> failed(false);
+  parallel_for(0, A.groups(), (long long) A.groups() * n * n * (needQ ? n : 1) * L, [&](int lo, int hi) {
+    std::vector<T> d(n * L), e(std::max(n - 1, 0) * L), z(needQ ? size_t(n) * n * L : 0);
+    std::vector<int> perm(n);
+    for (int g = lo; g < hi && !failed; g++) {
+      std::copy(A.diagonal(g), A.diagonal(g) + d.size(), d.begin());
+      std::copy(A.off_diagonal(g), A.off_diagonal(g) + e.size(), e.begin());
+      if (needQ) {
+        set_identity(n, z.data());
+      }
+      auto negligible = [&](int i, int l) {
+        T ei = std::abs(e[i * L + l]);
+        return ei < EPS || ei <= std::numeric_limits<T>::epsilon() * (std::abs(d[i * L + l]) + std::abs(d[(i + 1) * L + l]));
+      };
+
+      // lane l works on the block [first[l], last[l]]; last[l] is the eigenvalue being deflated
+      int first[L], last[L], iters[L] = {};
+      T shift[L], x[L], bulge[L];
+      std::fill(last, last + L, n - 1);
+      while (!failed) {
+        int from = n, to = 0;
+        for (int l = 0; l < L; l++) {
+          while (last[l] > 0 && negligible(last[l] - 1, l)) {
+            e[(last[l] - 1) * L + l] = 0;
+            last[l]--;
+            iters[l] = 0;
+          }
+          if (last[l] == 0) {
+            first[l] = n;// never inside the sweep
+            continue;
+          }
+          if (++iters[l] > LIMIT) {
+            failed = true;
+          }
+          const int m = last[l];
+          first[l] = m - 1;
+          while (first[l] > 0 && !negligible(first[l] - 1, l)) {
+            first[l]--;
+          }
+          shift[l] = wilkinson_shift(d[(m - 1) * L + l], e[(m - 1) * L + l], d[m * L + l]);
+          from = std::min(from, first[l]);
+          to = std::max(to, m);
+        }
+        if (from >= to) {
+          break;
+        }
+        for (int k = from; k < to; k++) {
+          T c[L], s[L];
+          for (int l = 0; l < L; l++) {
+            const bool start = (k == first[l]), inside = (k >= first[l] && k < last[l]);
+            const T xx = (start ? d[k * L + l] - shift[l] : x[l]);
+            const T zz = (start ? e[k * L + l] : bulge[l]);
+            const T r = std::sqrt(xx * xx + zz * zz);
+            const bool rotate = inside && r != 0;
+            c[l] = (rotate ? xx / r : T(1));
+            s[l] = (rotate ? zz / r : T(0));
+            if (k > 0 && inside && !start) {
+              e[(k - 1) * L + l] = r;
+            }
+            const T dk = d[k * L + l], dk1 = d[(k + 1) * L + l], ek = e[k * L + l];
+            d[k * L + l] = c[l] * c[l] * dk + 2 * c[l] * s[l] * ek + s[l] * s[l] * dk1;
+            d[(k + 1) * L + l] = s[l] * s[l] * dk - 2 * c[l] * s[l] * ek + c[l] * c[l] * dk1;
+            e[k * L + l] = c[l] * s[l] * (dk1 - dk) + (c[l] * c[l] - s[l] * s[l]) * ek;
+            x[l] = e[k * L + l];
+            if (k + 2 < n) {// the bulge at (k, k + 2); outside the block e[k + 1] is zero or c = 1
+              bulge[l] = s[l] * e[(k + 1) * L + l];
+              e[(k + 1) * L + l] *= c[l];
+            }
+          }
+          if (needQ) {
+            for (int i = 0; i < n; i++) {
+              T *z_i = z.data() + size_t(i) * n * L;
+              for (int l = 0; l < L; l++) {
+                const T zk = z_i[k * L + l], zk1 = z_i[(k + 1) * L + l];
+                z_i[k * L + l] = zk * c[l] + zk1 * s[l];
+                z_i[(k + 1) * L + l] = -zk * s[l] + zk1 * c[l];
+              }
+            }
+          }
+        }
+      }
+
+      for (int l = 0; l < L && g * L + l < A.count; l++) {
+        const int idx = g * L + l;
+        std::iota(perm.begin(), perm.end(), 0);
+        std::sort(perm.begin(), perm.end(), [&](int a, int b) { return d[a * L + l] < d[b * L + l]; });
+        for (int j = 0; j < n; j++) {
+          values[size_t(idx) * n + j] = d[perm[j] * L + l];
+        }
+        if (needQ) {
+          for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+              Z(idx, i, j) = z[(size_t(i) * n + perm[j]) * L + l];
+            }
+          }
+        }
+      }
+    }
+  });
+  if (failed) {
+    return std::nullopt;
+  }
+  return std::optional(make_pair(values, Z));
+}
+
+// Spectra of a batch of symmetric matrices: tridiagonalization_batched, then eigen_qr_shift_batched.
+template<typename T>
+std::optional<std::vector<T>> eigen_values_batched(const MatrixBatch<T> &A, const double EPS = 1e-3) {
+  auto res = eigen_qr_shift_batched(tridiagonalization_batched(A).first, false, EPS);
+  if (!res) {
+    return std::nullopt;
+  }
+  return std::optional(std::move(res->first));
+}
+
+}
+
+#endif//LINEAR_METHODS_BATCHED_HPP_
@@ -0,0 +1,172 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_METHODS_BISECTION_HPP_
+#define LINEAR_METHODS_BISECTION_HPP_
+
+#include "../core/sym_tridiagonal.hpp"
+#include "../core/thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace Linear {
+
+/*
+ * Sturm counts of a symmetric tridiagonal matrix: count(x) is the number of eigenvalues less than x,
+ * i.e. the number of negative pivots of the LDL^T factorization of A - x * I.
+ * The squares of the off-diagonal and the pivot guard are computed once for all shifts.
+ */
+template<typename T>
+struct SturmSequence {
+  // Shifts evaluated together; the loop over them has no dependencies and is vectorized.
+  static const int LANES = 8;
+
+  const std::vector<T> &d;
+  std::vector<T> e2;
+  T pivmin;
+
+  explicit SturmSequence(const SymTridiagonal<T> &A) : d(A.d), e2(A.e.size()) {
+    T emax = 1;
+    for (size_t i = 0; i < e2.size(); i++) {
+      e2[i] = A.e[i] * A.e[i];
+      emax = std::max(emax, e2[i]);
+    }
+    pivmin = std::numeric_limits<T>::min() * emax;
+  }
+
+  int operator()(T x) const {
+    T xs[LANES];
+    int counts[LANES];
+    std::fill(xs, xs + LANES, x);
+    count(xs, counts);
+    return counts[0];
+  }
+
+  // counts[l] = count(x[l]) for LANES shifts at once
+  void count(const T *x, int *counts) const {
+    const int n = d.size();
+    T q[LANES];
+    for (int l = 0; l < LANES; l++) {
+      q[l] = d[0] - x[l];
+      q[l] = (std::abs(q[l]) < pivmin ? -pivmin : q[l]);
+      counts[l] = q[l] < 0;
+    }
+    for (int i = 1; i < n; i++) {
+      const T di = d[i], ei = e2[i - 1];
+      for (int l = 0; l < LANES; l++) {
+        T t = (di - x[l]) - ei / q[l];
+        q[l] = (std::abs(t) < pivmin ? -pivmin : t);
+        counts[l] += q[l] < 0;
+      }
+    }
+  }
+};
+
+template<typename T>
+int sturm_count(const SymTridiagonal<T> &A, T x) {
+  return SturmSequence<T>(A)(x);
+}
+
+/*
+ * Eigenvalues number il..iu (ascending order, 0-based, inclusive) of a symmetric tridiagonal matrix
+ * by bisection on Sturm counts, in O(n * (iu - il + 1) * log(1 / eps)).
+ * Every eigenvalue has its own interval; LANES of them are halved per Sturm sweep,
+ * and groups of intervals are refined in parallel.
+ */
+template<typename T>
+std::vector<T> eigen_bisection(const SymTridiagonal<T> &A, int il, int iu) {
+  const int n = A.n;
+  if (il < 0 || iu >= n || il > iu + 1) {
+    throw std::runtime_error("Bad eigenvalue indices!");
+  }
+  const int k = iu - il + 1;
+  if (k == 0) {
+    return {};
+  }
+
+  // Gershgorin bounds
+  T lower = A.d[0], upper = A.d[0];
+  for (int i = 0; i < n; i++) {
+    T r = (i > 0 ? std::abs(A.e[i - 1]) : 0) + (i + 1 < n ? std::abs(A.e[i]) : 0);
+    lower = std::min(lower, A.d[i] - r);
+    upper = std::max(upper, A.d[i] + r);
+  }
+  const T eps = std::numeric_limits<T>::epsilon();
+  const T slack = 2 * eps * std::max(std::abs(lower), std::abs(upper)) + std::numeric_limits<T>::min();
+  lower -= slack;
+  upper += slack;
+
+  const SturmSequence<T> sturm(A);
+  const int LANES = SturmSequence<T>::LANES;
+  const int groups = (k + LANES - 1) / LANES;
+  std::vector<T> res(k);
+  parallel_for(0, groups, 64LL * n * k, [&](int lo, int hi) {
+    T left[LANES], right[LANES], mid[LANES];
+    int counts[LANES];
+    for (int g = lo; g < hi; g++) {
+      const int first = il + g * LANES, lanes = std::min(LANES, iu + 1 - first);
+      std::fill(left, left + LANES, lower);
+      std::fill(right, right + LANES, upper);
+      // invariant for lane l: count(left) <= first + l < count(right)
+      for (int iter = 0; iter < std::numeric_limits<T>::digits + 64; iter++) {
+        bool active = false;
+        for (int l = 0; l < LANES; l++) {
+          mid[l] = (left[l] + right[l]) / 2;
+          active |= (l < lanes && right[l] - left[l] > 2 * eps * std::max(std::abs(left[l]), std::abs(right[l])));
+        }
+        if (!active) {
+          break;
+        }
+        sturm.count(mid, counts);
+        for (int l = 0; l < LANES; l++) {
+          (counts[l] > first + l ? right[l] : left[l]) = mid[l];
+        }
+      }
+      for (int l = 0; l < lanes; l++) {
+        res[first - il + l] = (left[l] + right[l]) / 2;
+      }
+    }
+  });
+  return res;
+}
+
+// Eigenvalue number k in ascending order (0-based).
+template<typename T>
+T eigen_bisection(const SymTridiagonal<T> &A, int k) {
+  return eigen_bisection(A, k, k)[0];
+}
+
+// All eigenvalues in [lo, hi], ascending.
+template<typename T>
+std::vector<T> eigen_bisection_interval(const SymTridiagonal<T> &A, T lo, T hi) {
+  if (hi < lo) {
+    return {};
+  }
+  const SturmSequence<T> sturm(A);
+  const int il = sturm(lo), iu = sturm(std::nextafter(hi, std::numeric_limits<T>::infinity())) - 1;
+  return eigen_bisection(A, il, iu);
+}
+
+template<typename T>
+std::vector<T> eigen_bisection(const Matrix<T> &A, int il, int iu) {// A should be tridiagonalized
+  return eigen_bisection(SymTridiagonal<T>(A), il, iu);
+}
+
+template<typename T>
+T eigen_bisection(const Matrix<T> &A, int k) {// A should be tridiagonalized
+  return eigen_bisection(SymTridiagonal<T>(A), k);
+}
+
+template<typename T>
+std::vector<T> eigen_bisection_interval(const Matrix<T> &A, T lo, T hi) {// A should be tridiagonalized
+  return eigen_bisection_interval(SymTridiagonal<T>(A), lo, hi);
+}
+
+}
+
+#endif//LINEAR_METHODS_BISECTION_HPP_
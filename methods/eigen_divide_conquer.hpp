@@ -0,0 +1,313 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_METHODS_EIGEN_DIVIDE_CONQUER_HPP_
+#define LINEAR_METHODS_EIGEN_DIVIDE_CONQUER_HPP_
+
+#include "../core/gemm.hpp"
+#include "../core/sym_tridiagonal.hpp"
+#include "../core/thread_pool.hpp"
+#include "eigen_qr_shifts.hpp"
+#include "givens.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+
+namespace Linear {
+
+/*
+ * Root number i of the secular equation f(lambda) = 1 + rho * sum z_j^2 / (d_j - lambda) = 0,
+ * d ascending and distinct, rho > 0: it lies in (d[i], d[i + 1]), the last one in (d[i], d[i] + rho * |z|^2).
+ * The root is returned as lambda = d[origin] + tau with origin the closer pole, so that the
+ * differences d_j - lambda = (d_j - d[origin]) - tau are formed without cancellation.
+ * f is increasing between the poles; Newton steps are safeguarded by bisection.
+ */
+template<typename T>
+std::pair<int, T> secular_root(const std::vector<T> &d, const std::vector<T> &z, T rho, int i) {
+  const int K = d.size();
+  auto f = [&](int origin, T tau, T &derivative) {
+    T value = 1;
+    derivative = 0;
+    for (int j = 0; j < K; j++) {
+      T t = z[j] / ((d[j] - d[origin]) - tau);
+      value += rho * z[j] * t;
+      derivative += rho * t * t;
+    }
+    return value;
+  };
+
+  int origin = i;
+  T lo = 0, hi, derivative;
+  if (i + 1 < K) {
+    T gap = d[i + 1] - d[i];
+    if (f(i, gap / 2, derivative) >= 0) {
+      hi = gap / 2;
+    } else {
+      origin = i + 1;
+      lo = -gap / 2;
+      hi = 0;
+    }
+  } else {
+    hi = rho * std::inner_product(z.begin(), z.end(), z.begin(), T(0));
+  }
+
+  const T eps = std::numeric_limits<T>::epsilon();
+  T tau = (lo + hi) / 2;
+  for (int iter = 0; iter < LIMIT && hi - lo > 2 * eps * std::max(std::abs(lo), std::abs(hi)); iter++) {
+    T value = f(origin, tau, derivative);
+    if (value == 0) {
+      break;
+    }
+    (value < 0 ? lo : hi) = tau;
+    T next = tau - value / derivative;
+    if (!(next > lo && next < hi)) {
+      next = (lo + hi) / 2;
+    }
+    if (std::abs(next - tau) <= eps * std::abs(tau)) {
+      tau = next;
+      break;
+    }
+    tau = next;
+  }
+  return {origin, tau};
+}
+
+/*
+ * Eigen decomposition of D + rho * z * z^T, D = diag(d): ascending eigenvalues and U with the
+ * eigenvectors as columns. Components of z that are negligible and poles closer than the tolerance
+ * are deflated (the latter after a rotation that moves the weight of z onto one of them);
+ * the rest go through the secular equation. The vectors are built from the z recomputed from the
+ * computed roots by the Loewner formula (Gu, Eisenstat), which keeps them orthogonal.
+ */
+template<typename T>
+std::pair<std::vector<T>, Matrix<T>> rank_one_update_eigen(std::vector<T> d, std::vector<T> z, T rho) {
+  const int m = d.size();
+  const bool flip = rho < 0;// D + rho * z * z^T = -(-D + |rho| * z * z^T)
+  if (flip) {
+    for (auto &x : d) {
+      x = -x;
+    }
+    rho = -rho;
+  }
+  T norm = std::sqrt(std::inner_product(z.begin(), z.end(), z.begin(), T(0)));
+  if (norm != 0) {
+    for (auto &x : z) {
+      x /= norm;
+    }
+  }
+  rho *= norm * norm;
+
+  std::vector<int> perm(m);
+  std::iota(perm.begin(), perm.end(), 0);
+  std::sort(perm.begin(), perm.end(), [&](int a, int b) { return d[a] < d[b]; });
+  std::vector<T> ds(m), zs(m);
+  T dmax = 0;
+  for (int i = 0; i < m; i++) {
+    ds[i] = d[perm[i]];
+    zs[i] = z[perm[i]];
+    dmax = std::max(dmax, std::abs(ds[i]));
+  }
+
+  const T tol = 8 * std::numeric_limits<T>::epsilon() * std::max(dmax, rho);
+  std::vector<char> deflated(m);
+  GivensSequence<T> rotations(m);
+  for (int j = 0, p = -1; j < m; j++) {
+    if (rho * std::abs(zs[j]) <= tol) {
+      deflated[j] = 1;
+      continue;
+    }
+    if (p >= 0 && ds[j] - ds[p] <= tol) {
+      GivensMatrix G(p, j, zs[p], zs[j]);
+      const T c = G.c, s = G.s, dp = ds[p], dj = ds[j];
+      ds[p] = c * c * dp + s * s * dj;
+      ds[j] = s * s * dp + c * c * dj;
+      zs[j] = std::hypot(zs[p], zs[j]);
+      zs[p] = 0;
+      deflated[p] = 1;
+      rotations.push(G);
+    }
+    p = j;
+  }
+
+  std::vector<int> kept;
+  for (int j = 0; j < m; j++) {
+    if (!deflated[j]) {
+      kept.push_back(j);
+    }
+  }
+  const int K = kept.size();
+  std::vector<T> dk(K), zk(K), zhat(K), tau(K);
+  std::vector<int> origin(K);
+  for (int i = 0; i < K; i++) {
+    dk[i] = ds[kept[i]];
+    zk[i] = zs[kept[i]];
+  }
+  parallel_for(0, K, 32LL * K * K, [&](int lo, int hi) {
+    for (int i = lo; i < hi; i++) {
+      std::tie(origin[i], tau[i]) = secular_root(dk, zk, rho, i);
+    }
+  });
+  // lambda_i - d_j
+  auto shifted = [&](int i, int j) { return (dk[origin[i]] - dk[j]) + tau[i]; };
+  parallel_for(0, K, 4LL * K * K, [&](int lo, int hi) {
+    for (int j = lo; j < hi; j++) {
+      T prod = shifted(K - 1, j) / rho;
+      for (int i = 0; i < j; i++) {
+        prod *= shifted(i, j) / (dk[i] - dk[j]);
+      }
+      for (int i = j; i + 1 < K; i++) {
+        prod *= shifted(i, j) / (dk[i + 1] - dk[j]);
+      }
+      zhat[j] = std::copysign(std::sqrt(std::max(prod, T(0))), zk[j]);
+    }
+  });
+
+  // (eigenvalue, root number) with root number -1 - j for the deflated pole j
+  std::vector<std::pair<T, int>> order;
+  for (int i = 0; i < K; i++) {
+    order.emplace_back(dk[origin[i]] + tau[i], i);
+  }
+  for (int j = 0; j < m; j++) {
+    if (deflated[j]) {
+      order.emplace_back(ds[j], -1 - j);
+    }
+  }
+  std::sort(order.begin(), order.end());
+
+  Matrix<T> V(m);
+  std::vector<T> lambda(m);
+  parallel_for(0, m, 2LL * m * K, [&](int lo, int hi) {
+    std::vector<T> v(K);
+    for (int col = lo; col < hi; col++) {
+      lambda[col] = order[col].first;
+      int i = order[col].second;
+      if (i < 0) {
+        V[-1 - i][col] = 1;
+        continue;
+      }
+      T sum = 0;
+      for (int j = 0; j < K; j++) {
+        v[j] = zhat[j] / -shifted(i, j);
+        sum += v[j] * v[j];
+      }
+      sum = std::sqrt(sum);
+      for (int j = 0; j < K; j++) {
+        V[kept[j]][col] = v[j] / sum;
+      }
+    }
+  });
+  rotations.apply(V);
+
+  Matrix<T> U(m);
+  for (int i = 0; i < m; i++) {
+    for (int j = 0; j < m; j++) {
+      U[perm[i]][flip ? m - 1 - j : j] = V[i][j];
+    }
+  }
+  if (flip) {
+    std::reverse(lambda.begin(), lambda.end());
+    for (auto &x : lambda) {
+      x = -x;
+    }
+  }
+  return {lambda, U};
+}
+
+/*
+ * Cuppen's split: T = diag(T1, T2) + beta * v * v^T with v = e_{k-1} + e_k, beta = e[k - 1],
+ * T1 and T2 having beta subtracted from their touching diagonal entries. The halves are solved
+ * concurrently, then T = diag(Q1, Q2) * (L + beta * z * z^T) * diag(Q1, Q2)^T with z = diag(Q1, Q2)^T * v.
+ * Blocks of at most `leaf` rows go to the implicit QR.
+ */
+template<typename T>
+bool divide_conquer(std::vector<T> d, std::vector<T> e, std::vector<T> &lambda, Matrix<T> &Q, int leaf) {
+  const int m = d.size();
+  if (m <= leaf) {
+    SymTridiagonal<T> A(std::move(d), std::move(e));
+    Q = identity<T>(m);
+    if (!tridiagonal_qr(A, &Q, 0)) {
+      return false;
+    }
+    lambda = std::move(A.d);
+    return true;
+  }
+
+  const int k = m / 2;
+  const T beta = e[k - 1];
+  std::vector<T> d1(d.begin(), d.begin() + k), d2(d.begin() + k, d.end());
+  std::vector<T> e1(e.begin(), e.begin() + k - 1), e2(e.begin() + k, e.end());
+  d1[k - 1] -= beta;
+  d2[0] -= beta;
+
+  std::vector<T> lambda1, lambda2;
+  Matrix<T> Q1(0), Q2(0);
+  bool ok1 = false, ok2 = false;
+  {
+    TaskGroup group;
+    group.run([&] { ok1 = divide_conquer(std::move(d1), std::move(e1), lambda1, Q1, leaf); });
+    ok2 = divide_conquer(std::move(d2), std::move(e2), lambda2, Q2, leaf);
+    group.wait();
+  }
+  if (!ok1 || !ok2) {
+    return false;
+  }
+
+  std::vector<T> z(m);
+  for (int j = 0; j < k; j++) {
+    z[j] = Q1[k - 1][j];
+  }
+  for (int j = k; j < m; j++) {
+    z[j] = Q2[0][j - k];
+  }
+  lambda1.insert(lambda1.end(), lambda2.begin(), lambda2.end());
+  auto [values, U] = rank_one_update_eigen(std::move(lambda1), std::move(z), beta);
+
+  lambda = std::move(values);
+  Q = Matrix<T>(m);
+  gemm(k, m, k, T(1), Q1.data(), Q1.stride(), U.row_data(0), U.stride(), T(0), Q.row_data(0), Q.stride());
+  gemm(m - k, m, m - k, T(1), Q2.data(), Q2.stride(), U.row_data(k), U.stride(), T(0), Q.row_data(k), Q.stride());
+  return true;
+}
+
+/*
+ * Eigenvalues (ascending) and eigenvectors Q (as columns, A = Q * diag * Q^T) of a symmetric
+ * tridiagonal matrix by Cuppen's divide and conquer. Costs O(n^3) like QR with vectors, but the
+ * work is in the secular equations and in gemm, and the two halves of every split run in parallel.
+ */
+template<typename T>
+std::optional<std::pair<std::vector<T>, Matrix<T>>> eigen_divide_conquer(const SymTridiagonal<T> &A, int leaf = 32) {
+  std::vector<T> lambda;
+  Matrix<T> Q(0);
+  if (!divide_conquer(A.d, A.e, lambda, Q, std::max(leaf, 2))) {
+    return std::nullopt;
+  }
+  if (A.n <= std::max(leaf, 2)) {// the QR on a single leaf does not sort
+    std::vector<int> perm(A.n);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::sort(perm.begin(), perm.end(), [&](int a, int b) { return lambda[a] < lambda[b]; });
+    std::vector<T> sorted(A.n);
+    Matrix<T> sorted_Q(A.n);
+    for (int j = 0; j < A.n; j++) {
+      sorted[j] = lambda[perm[j]];
+      for (int i = 0; i < A.n; i++) {
+        sorted_Q[i][j] = Q[i][perm[j]];
+      }
+    }
+    lambda = std::move(sorted);
+    Q = std::move(sorted_Q);
+  }
+  return std::optional(make_pair(lambda, Q));
+}
+
+template<typename T>
+std::optional<std::pair<std::vector<T>, Matrix<T>>> eigen_divide_conquer(const Matrix<T> &A, int leaf = 32) {// A should be tridiagonalized
+  return eigen_divide_conquer(SymTridiagonal<T>(A), leaf);
+}
+
+}
+
+#endif//LINEAR_METHODS_EIGEN_DIVIDE_CONQUER_HPP_
@@ -0,0 +1,458 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_METHODS_EIGEN_FRANCIS_HPP_
+#define LINEAR_METHODS_EIGEN_FRANCIS_HPP_
+
+#include "../core/gemm.hpp"
+#include "../core/report.hpp"
+#include "../core/thread_pool.hpp"
+#include "../core/util.hpp"
+#include "householder.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <limits>
+#include <optional>
+
+namespace Linear {
+
+extern const int LIMIT;
+
+/*
+ * H := (I - tau * v * v^T) * H on rows r0..r0 + m - 1 and columns [from, to), v of length m.
+ * w = v^T * H is accumulated row by row, so both passes run along the rows of H.
+ */
+template<typename T>
+void reflect_rows(Matrix<T> &H, const T *v, T tau, int r0, int m, int from, int to) {
+  parallel_for(from, to, 2LL * m * (to - from), [&](int lo, int hi) {
+    std::vector<T> w(hi - lo);
+    for (int r = 0; r < m; r++) {
+      const T *h_r = H.row_data(r0 + r) + lo;
+      for (int j = 0; j < hi - lo; j++) {
+        w[j] += v[r] * h_r[j];
+      }
+    }
+    for (int r = 0; r < m; r++) {
+      T *h_r = H.row_data(r0 + r) + lo;
+      const T k = tau * v[r];
+      for (int j = 0; j < hi - lo; j++) {
+        h_r[j] -= k * w[j];
+      }
+    }
+  });
+}
+
+// H := H * (I - tau * v * v^T) on rows [from, to) and columns c0..c0 + m - 1.
+template<typename T>
+void reflect_columns(Matrix<T> &H, const T *v, T tau, int c0, int m, int from, int to) {
+  parallel_for(from, to, 2LL * m * (to - from), [&](int lo, int hi) {
+    for (int r = lo; r < hi; r++) {
+      T *h_r = H.row_data(r) + c0;
+      T s = 0;
+      for (int k = 0; k < m; k++) {
+        s += h_r[k] * v[k];
+      }
+      s *= tau;
+      for (int k = 0; k < m; k++) {
+        h_r[k] -= s * v[k];
+      }
+    }
+  });
+}
+
+/*
+ * Householder reduction of the block [lo + 1, hi) of H to upper Hessenberg form, starting from column lo:
+ * reflector c zeroes H[c + 2..hi)[c]. Rows are updated on columns up to `last`, columns on rows from
+ * `first`, and Z, if given, is multiplied by the reflectors from the right. About 10 / 3 * n^3 flops
+ * for the whole matrix.
+ */
+template<typename T>
+void hessenberg_reduction(Matrix<T> &H, Matrix<T> *Z, int lo, int hi, int first, int last) {
+  std::vector<T> v(std::max(hi - lo, 0));
+  for (int c = lo; c + 2 < hi; c++) {
+    const int m = hi - c - 1;
+    const T tau = make_reflector(m, H.row_data(c + 1) + c, H.stride());
+    if (tau == 0) {
+      continue;
+    }
+    v[0] = 1;
+    for (int r = 1; r < m; r++) {
+      v[r] = H[c + 1 + r][c];
+      H[c + 1 + r][c] = 0;
+    }
+    reflect_rows(H, v.data(), tau, c + 1, m, c + 1, last);
+    reflect_columns(H, v.data(), tau, c + 1, m, first, hi);
+    if (Z) {
+      reflect_columns(*Z, v.data(), tau, c + 1, m, 0, Z->n);
+    }
+  }
+}
+
+/*
+ * A = Q * H * Q^T with H upper Hessenberg; returns {H, Q}.
+ */
+template<typename T>
+std::pair<Matrix<T>, Matrix<T>> hessenberg(const Matrix<T> &A) {
+  Matrix<T> H = A;
+  Matrix<T> Q = identity<T>(A.n);
+  hessenberg_reduction(H, &Q, 0, A.n, 0, A.n);
+  return {std::move(H), std::move(Q)};
+}
+
+// Whether the subdiagonal H[k][k - 1] may be dropped, splitting H between k - 1 and k.
+template<typename T>
+bool negligible_subdiagonal(const Matrix<T> &H, int k, const double EPS) {
+  T h = std::abs(H[k][k - 1]);
+  return h < EPS || h <= std::numeric_limits<T>::epsilon() * (std::abs(H[k - 1][k - 1]) + std::abs(H[k][k]));
+}
+
+/*
+ * One implicit double-shift (Francis) QR step on the unreduced block [l, i] of the Hessenberg H.
+ * The shifts are the roots of z^2 - (x + y) * z + (x * y - w); the first column of their product
+ * (H - s1) * (H - s2) is made of three nonzeros, and the 3 x 3 reflector that maps it onto e_1 leaves
+ * a bulge that further reflectors chase down the band. The step starts lower than l if two consecutive
+ * small subdiagonals make that possible. With Z, rows and columns of H are updated in full
+ * (for the Schur form) and Z is multiplied by the reflectors; otherwise only the block is touched.
+ */
+template<typename T>
+void francis_step(Matrix<T> &H, Matrix<T> *Z, int l, int i, T x, T y, T w) {
+  const T ulp = std::numeric_limits<T>::epsilon();
+  const int first = (Z ? 0 : l), last = (Z ? H.n : i + 1);
+  T p = 0, q = 0, r = 0;
+  int m = i - 2;
+  for (;; m--) {
+    const T z = H[m][m];
+    r = x - z;
+    T s = y - z;
+    p = (r * s - w) / H[m + 1][m] + H[m][m + 1];
+    q = H[m + 1][m + 1] - z - r - s;
+    r = H[m + 2][m + 1];
+    s = std::abs(p) + std::abs(q) + std::abs(r);
+    p /= s;
+    q /= s;
+    r /= s;
+    if (m == l) {
+      break;
+    }
+    T u = std::abs(H[m][m - 1]) * (std::abs(q) + std::abs(r));
+    T v = std::abs(p) * (std::abs(H[m - 1][m - 1]) + std::abs(z) + std::abs(H[m + 1][m + 1]));
+    if (u <= ulp * v) {
+      break;
+    }
+  }
+  for (int k = m; k < i; k++) {
+    const bool three = (k != i - 1);// the last reflector is 2 x 2
+    T scale = 1;
+    if (k != m) {
+      p = H[k][k - 1];
+      q = H[k + 1][k - 1];
+      r = (three ? H[k + 2][k - 1] : T(0));
+      scale = std::abs(p) + std::abs(q) + std::abs(r);
+      if (scale == 0) {
+        continue;
+      }
+      p /= scale;
+      q /= scale;
+      r /= scale;
+    }
+    const T s = std::copysign(std::sqrt(p * p + q * q + r * r), p);
+    if (s == 0) {
+      continue;
+    }
+    if (k != m) {// the reflector annihilates the bulge below H[k][k - 1]
+      H[k][k - 1] = -s * scale;
+      H[k + 1][k - 1] = 0;
+      if (three) {
+        H[k + 2][k - 1] = 0;
+      }
+    } else if (l != m) {
+      H[k][k - 1] = -H[k][k - 1];
+    }
+    p += s;
+    const T vx = p / s, vy = q / s, vz = r / s;
+    q /= p;
+    r /= p;
+    for (int j = k; j < last; j++) {
+      T t = H[k][j] + q * H[k + 1][j];
+      if (three) {
+        t += r * H[k + 2][j];
+        H[k + 2][j] -= t * vz;
+      }
+      H[k + 1][j] -= t * vy;
+      H[k][j] -= t * vx;
+    }
+    auto columns = [&](Matrix<T> &M, int from, int to) {
+      for (int c = from; c < to; c++) {
+        T *m_c = M.row_data(c) + k;
+        T t = vx * m_c[0] + vy * m_c[1];
+        if (three) {
+          t += vz * m_c[2];
+          m_c[2] -= t * r;
+        }
+        m_c[1] -= t * q;
+        m_c[0] -= t;
+      }
+    };
+    columns(H, first, std::min(i, k + 3) + 1);
+    if (Z) {
+      columns(*Z, 0, Z->n);
+    }
+  }
+}
+
+/*
+ * Eigenvalues of the 2 x 2 block at rows i - 1, i, a real or complex conjugate pair. With Z, a block
+ * with real eigenvalues is also rotated to upper triangular form, as in the real Schur form.
+ */
+template<typename T>
+void split_block(Matrix<T> &H, Matrix<T> *Z, int i, std::vector<std::complex<T>> &lambdas) {
+  const int k = i - 1;
+  const T x = H[i][i], y = H[k][k], w = H[i][k] * H[k][i];
+  const T p = (y - x) / 2, q = p * p + w;
+  T z = std::sqrt(std::abs(q));
+  if (q < 0) {
+    lambdas[k] = {x + p, z};
+    lambdas[i] = {x + p, -z};
+    return;
+  }
+  z = p + std::copysign(z, p);
+  lambdas[k] = x + z;
+  lambdas[i] = (z != 0 ? x - w / z : x + z);
+  if (!Z || H[i][k] == 0) {
+    return;
+  }
+  // the rotation (c, s) takes the eigenvector (z, H[i][k]) of the eigenvalue x + z onto e_1
+  const T r = std::hypot(H[i][k], z), c = z / r, s = H[i][k] / r;
+  auto rotate_pair = [&](T &a, T &b) {
+    const T t = a;
+    a = c * t + s * b;
+    b = c * b - s * t;
+  };
+  for (int j = k; j < H.n; j++) {
+    rotate_pair(H[k][j], H[i][j]);
+  }
+  for (int j = 0; j <= i; j++) {
+    rotate_pair(H[j][k], H[j][i]);
+  }
+  for (int j = 0; j < Z->n; j++) {
+    rotate_pair((*Z)[j][k], (*Z)[j][i]);
+  }
+  H[i][k] = 0;
+}
+
+template<typename T>
+bool francis_qr(Matrix<T> &H, Matrix<T> *Z, std::vector<std::complex<T>> &lambdas, const double EPS,
+                SolverReport *report = nullptr, SolverObserver *observer = nullptr, bool early_deflation = true);
+
+/*
+ * Aggressive early deflation, simplified: the trailing nw x nw window of the unreduced block [l, i]
+ * is brought to real Schur form T = V^T * W * V, which turns the single subdiagonal entry left of
+ * the window into the spike H[ks][ks - 1] * V[0][*]. Eigenvalues at the bottom of T whose spike entries
+ * are negligible are deflated, often many at once and long before a subdiagonal of H gets small.
+ * Unlike LAPACK's version, no eigenvalues are reordered: the search stops at the first one that does
+ * not deflate. If some deflate, the transformation is applied to H (and Z) and the rest of the window
+ * is brought back to Hessenberg form; otherwise H is left as it was. Either way, the last undeflated
+ * eigenvalues of the window go to `shifts`, in conjugate pairs: they make better shifts for the next
+ * steps than the trailing 2 x 2 block, which pays for the window. Returns the number deflated.
+ */
+template<typename T>
+int aggressive_early_deflation(Matrix<T> &H, Matrix<T> *Z, int l, int i, const double EPS,
+                               std::vector<std::complex<T>> &shifts) {
+  const int size = i - l + 1;
+  const int nw = std::min(size / 2, std::max(8, size / 16));
+  const int ks = i - nw + 1;
+  Matrix<T> W(nw);
+  for (int r = 0; r < nw; r++) {
+    std::copy(H.row_data(ks + r) + ks, H.row_data(ks + r) + i + 1, W.row_data(r));
+  }
+  Matrix<T> V = identity<T>(nw);
+  std::vector<std::complex<T>> mu(nw);
+  if (!francis_qr(W, &V, mu, EPS, nullptr, nullptr, false)) {
+    return 0;
+  }
+
+  const T spike = H[ks][ks - 1], ulp = std::numeric_limits<T>::epsilon();
+  int nd = 0;
+  for (int j = nw - 1; j >= 0;) {
+    const bool pair = (j > 0 && W[j][j - 1] != 0);
+    T s = std::abs(spike * V[0][j]), scale = std::abs(W[j][j]);
+    if (pair) {
+      s = std::max(s, std::abs(spike * V[0][j - 1]));
+      scale += std::sqrt(std::abs(W[j][j - 1])) * std::sqrt(std::abs(W[j - 1][j]));
+    }
+    if (!(s < EPS || s <= ulp * scale)) {
+      break;
+    }
+    nd += (pair ? 2 : 1);
+    j -= (pair ? 2 : 1);
+  }
+  const int nu = nw - nd;
+  int from = std::max(0, nu - std::max(2, nw / 2));
+  from += (from > 0 && mu[from].imag() < 0);// not between the two of a pair
+  /*
+   * francis_qr takes the shifts from the back two at a time as the roots of a real polynomial, so a
+   * conjugate pair has to stay together and the real shifts go in twos; if they are odd, the trailing
+   * one is dropped. Pairs come as (+, -), so walking down from nu meets the second of a pair first.
+   */
+  bool drop = std::count_if(mu.begin() + from, mu.begin() + nu, [](auto z) { return z.imag() == 0; }) % 2;
+  int single = -1;// a real shift waiting for a second one
+  shifts.clear();
+  for (int j = nu - 1; j >= from; j--) {
+    if (mu[j].imag() != 0) {
+      shifts.push_back(mu[j]);
+      shifts.push_back(mu[--j]);
+    } else if (drop) {
+      drop = false;
+    } else if (single < 0) {
+      single = j;
+    } else {
+      shifts.push_back(mu[single]);
+      shifts.push_back(mu[j]);
+      single = -1;
+    }
+  }
+  std::reverse(shifts.begin(), shifts.end());
+  if (nd == 0) {
+    return 0;
+  }
+
+  // H := diag(I, V, I)^T * H * diag(I, V, I)
+  const int first = (Z ? 0 : l), last = (Z ? H.n : i + 1);
+  for (int r = 0; r < nw; r++) {
+    std::copy(W.row_data(r), W.row_data(r) + nw, H.row_data(ks + r) + ks);
+    H[ks + r][ks - 1] = (r < nu ? spike * V[0][r] : T(0));
+  }
+  auto times_v = [&](Matrix<T> &M, int from, int to) {// M[from..to)[ks..i] *= V
+    if (to <= from) {
+      return;
+    }
+    std::vector<T> tmp(size_t(to - from) * nw);
+    gemm(to - from, nw, nw, T(1), M.row_data(from) + ks, M.stride(), V.data(), V.stride(), T(0), tmp.data(), nw);
+    for (int r = from; r < to; r++) {
+      std::copy(tmp.begin() + size_t(r - from) * nw, tmp.begin() + size_t(r - from + 1) * nw, M.row_data(r) + ks);
+    }
+  };
+  times_v(H, first, ks);
+  if (Z) {
+    times_v(*Z, 0, Z->n);
+  }
+  if (last > i + 1) {
+    const int cols = last - i - 1;
+    Matrix<T> Vt = V.transpose();
+    std::vector<T> tmp(size_t(nw) * cols);
+    gemm(nw, cols, nw, T(1), Vt.data(), Vt.stride(), H.row_data(ks) + i + 1, H.stride(), T(0), tmp.data(), cols);
+    for (int r = 0; r < nw; r++) {
+      std::copy(tmp.begin() + size_t(r) * cols, tmp.begin() + size_t(r + 1) * cols, H.row_data(ks + r) + i + 1);
+    }
+  }
+  // the spike fills column ks - 1 of the undeflated rows
+  hessenberg_reduction(H, Z, ks - 1, ks + nu, first, last);
+  return nd;
+}
+
+/*
+ * Real Schur form of an upper Hessenberg H by implicit double-shift QR with deflation; lambdas gets the
+ * eigenvalues, complex ones as conjugate pairs (positive imaginary part first). With Z, H ends up quasi
+ * triangular (2 x 2 blocks for the complex pairs) and Z is multiplied from the right by the
+ * transformations; without it only the eigenvalues are meaningful. Returns false if some eigenvalue
+ * takes more than LIMIT steps.
+ * Blocks of at least AED_MIN rows go through aggressive early deflation whenever the shifts it left are
+ * used up; the steps in between take those shifts two at a time. Otherwise the shifts are the eigenvalues
+ * of the trailing 2 x 2 block. Every 10th step on an eigenvalue uses exceptional shifts instead, which
+ * break the cycles the others can fall into.
+ * An observer sees every step with the subdiagonal element being driven to zero, and every deflation.
+ */
+template<typename T>
+bool francis_qr(Matrix<T> &H, Matrix<T> *Z, std::vector<std::complex<T>> &lambdas, const double EPS,
+                SolverReport *report, SolverObserver *observer, bool early_deflation) {
+  const int AED_MIN = 24;
+  const int n = H.n;
+  lambdas.assign(n, T(0));
+  Telemetry telemetry(report, observer);
+  int steps = 0, its = 0;
+  T neglected = 0;
+  std::vector<std::complex<T>> shifts;// pending shifts, used two at a time from the back
+  for (int i = n - 1; i >= 0;) {
+    int l = i;
+    while (l > 0 && !negligible_subdiagonal(H, l, EPS)) {
+      l--;
+    }
+    if (l > 0) {
+      neglected = std::max(neglected, std::abs(H[l][l - 1]));
+      H[l][l - 1] = 0;
+    }
+    if (l >= i - 1) {
+      if (l == i) {
+        lambdas[i] = H[i][i];
+      } else {
+        split_block(H, Z, i, lambdas);
+        telemetry.deflation(i--, steps);
+      }
+      telemetry.deflation(i--, steps);
+      its = 0;
+      shifts.clear();
+      continue;
+    }
+    if (its == LIMIT) {
+      telemetry.stop(StopReason::iteration_limit, steps, std::abs(H[i][i - 1]));
+      return false;
+    }
+    its++;
+    steps++;
+    const bool aed = early_deflation && i - l + 1 >= AED_MIN && shifts.size() < 2;
+    if (!aed || aggressive_early_deflation(H, Z, l, i, EPS, shifts) == 0) {
+      T x = H[i][i], y = H[i - 1][i - 1], w = H[i][i - 1] * H[i - 1][i];
+      if (its % 10 == 0) {
+        const T s = std::abs(H[i][i - 1]) + std::abs(H[i - 1][i - 2]);
+        x = y = H[i][i] + T(0.75) * s;
+        w = T(-0.4375) * s * s;
+      } else if (shifts.size() >= 2) {// roots of (z - s1) * (z - s2), a real polynomial
+        const std::complex<T> s1 = shifts.back(), s2 = shifts[shifts.size() - 2];
+        shifts.resize(shifts.size() - 2);
+        x = y = (s1 + s2).real() / 2;
+        w = x * x - (s1 * s2).real();
+      }
+      francis_step(H, Z, l, i, x, y, w);
+    }
+    telemetry.step(steps, std::abs(H[i][i - 1]));
+  }
+  telemetry.stop(StopReason::converged, steps, neglected);
+  return true;
+}
+
+/*
+ * Eigenvalues of a general (non-symmetric) matrix: Hessenberg reduction, then Francis QR.
+ * About 10 * n^3 flops in all, against O(n^3) per step of eigen_qr.
+ */
+template<typename T>
+std::optional<std::vector<std::complex<T>>> eigen_francis(const Matrix<T> &A, const double EPS = 1e-3,
+                                                          SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  Matrix<T> H = A;
+  hessenberg_reduction(H, static_cast<Matrix<T> *>(nullptr), 0, H.n, 0, H.n);
+  std::vector<std::complex<T>> lambdas;
+  if (!francis_qr(H, static_cast<Matrix<T> *>(nullptr), lambdas, EPS, report, observer)) {
+    return std::nullopt;
+  }
+  return lambdas;
+}
+
+/*
+ * Real Schur decomposition A = Z * S * Z^T, S quasi upper triangular; returns {S, Z}.
+ * The eigenvalues are read off the diagonal of S and its 2 x 2 blocks.
+ */
+template<typename T>
+std::optional<std::pair<Matrix<T>, Matrix<T>>> real_schur(const Matrix<T> &A, const double EPS = 1e-3,
+                                                          SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  auto [S, Z] = hessenberg(A);
+  std::vector<std::complex<T>> lambdas;
+  if (!francis_qr(S, &Z, lambdas, EPS, report, observer)) {
+    return std::nullopt;
+  }
+  return std::optional(std::make_pair(std::move(S), std::move(Z)));
+}
+
+}// namespace Linear
+
+#endif//LINEAR_METHODS_EIGEN_FRANCIS_HPP_
@@ -6,35 +6,58 @@
 #define LINEAR_METHODS_EIGEN_QR_HPP_
 
 #include "givens.hpp"
+#include "../core/report.hpp"
 #include "../core/util.hpp"
+#include "../core/vec.hpp"
+#include "../core/workspace.hpp"
 
 namespace Linear {
 
 extern const int ITERS;
 extern const int LIMIT;
 
-template<typename T>
-std::optional<std::pair<std::vector<T>, Matrix<T>>> eigen_qr(const Matrix<T> &A, const double EPS = 1e-3) {
+/*
+ * Eigenvalues and eigenvectors (columns of Q) by the unshifted QR algorithm; stops when every
+ * Gershgorin radius of the iterate is below EPS. Also instantiates for a fixed-size Matrix<T, N>,
+ * returning a Vec<T, N>, and then allocates nothing on the heap.
+ * The iterate and the rotations of its QR are reused from step to step; with a workspace they come
+ * from it and are recycled across calls too, so the heap only sees the returned Q and eigenvalues.
+ */
+template<typename T, int N>
+std::optional<std::pair<vec_t<T, N>, Matrix<T, N>>> eigen_qr(const Matrix<T, N> &A, const double EPS = 1e-3,
+                                                             SolverReport *report = nullptr, SolverObserver *observer = nullptr,
+                                                             Workspace *workspace = nullptr) {
   int n = A.n;
-  Matrix<T> Q = identity(n);
-  auto cur_A = A;
-  for (int i = 0; i < LIMIT; i++) {
-    auto [Q_new, R_new] = QR_givens(cur_A);
-    cur_A = R_new * Q_new;
+  Matrix<T, N> Q = identity<T, N>(n);
+  Matrix<T, N> cur_A = scratch_copy(workspace, A);
+  GivensSequence<T, N> Q_new(n, workspace);
+  Telemetry telemetry(report, observer);
+  long double rad = 0;
+  for (int i = 1; i <= LIMIT; i++) {
+    QR_givens_in_place(cur_A, Q_new); // O(n^3)
+    cur_A *= Q_new;
     Q *= Q_new;
-    std::vector<std::pair<T, long double>> circles = gershgorin_circles(cur_A);
-    long double rad = 0;
-    for (auto &i : circles) {
-      rad = std::max(rad, i.second);
+    rad = 0;
+    for (int r = 0; r < n; r++) {
+      long double radius = 0;
+      for (int c = 0; c < n; c++) {
+        if (r != c) {
+          radius += std::abs(cur_A[r][c]);
+        }
+      }
+      rad = std::max(rad, radius);
     }
+    telemetry.step(i, rad);
     if (rad < EPS) {
-      std::vector<T> lambdas(n);
-      for (auto i = 0; i < n; i++) {
-        lambdas[i] = circles[i].first;
+      telemetry.stop(StopReason::converged, i, rad);
+      vec_t<T, N> lambdas(n);
+      for (auto r = 0; r < n; r++) {
+        lambdas[r] = cur_A[r][r];
       }
-      return std::optional(make_pair(lambdas, Q));
+      return std::optional(std::make_pair(std::move(lambdas), std::move(Q)));
     }
   }
+  telemetry.stop(StopReason::iteration_limit, LIMIT, rad);
   return std::nullopt;
 }
 
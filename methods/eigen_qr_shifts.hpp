@@ -5,9 +5,13 @@
 #ifndef LINEAR_METHODS_QR_SHIFTS_HPP_
 #define LINEAR_METHODS_QR_SHIFTS_HPP_
 
+#include "../core/report.hpp"
+#include "../core/sym_tridiagonal.hpp"
 #include "../core/util.hpp"
 #include "givens.hpp"
 
+#include <limits>
+
 namespace Linear {
 
 extern const int LIMIT;
@@ -18,10 +22,10 @@ int sgn(const T &val) {
 }
 
 template<typename T>
-T wilkinson_shift(const T &A, const T &B, const T &C) {// for matrix ((A, B), (B, C))
-  T x1 = 0.5 * (-sqrt(A * A - 2 * A * C + 4 * B * B + C * C) + A + C);
-  T x2 = 0.5 * (+sqrt(A * A - 2 * A * C + 4 * B * B + C * C) + A + C);
-  return (std::abs(x1 - C) < std::abs(x2 - C) ? x1 : x2);
+T wilkinson_shift(const T &A, const T &B, const T &C) {// for matrix ((A, B), (B, C)): its eigenvalue closer to C
+  T delta = (A - C) / 2;
+  T denom = delta + (delta < 0 ? -1 : 1) * std::hypot(delta, B);
+  return (denom == 0 ? C : C - B * B / denom);
 }
 
 template<typename T>
@@ -39,35 +43,106 @@ Matrix<T> fast_multiplication(const Matrix<T> &R, const Matrix<T> &Q) { // R sho
 }
 
 template<typename T>
-std::optional<std::pair<std::vector<T>, Matrix<T>>> eigen_qr_shift(const Matrix<T> &A, bool needQ = 0, const double EPS = 1e-3) {// A should be tridiagonalized
-  int n = A.n;
-  Matrix<T> Q = identity(n);
-  if (n == 1) {
-    return std::optional(std::make_pair(std::vector<T>{A[0][0]}, Q));
+Matrix<T> fast_multiplication(const Matrix<T> &R, const GivensSequence<T> &Q) { // same for Q from QR_givens_tridiagonalization
+  int n = R.n;
+  Matrix<T> res = R;
+  for (const auto &G : Q.rotations) { // columns G.i and G.j are adjacent, only a few rows around them are nonzero
+    rotate_columns(res, G, std::max(0, std::min(G.i, G.j) - 2), std::min(n, std::max(G.i, G.j) + 2));
   }
-  auto cur_A = A;
-  std::vector<T> lambdas(n);
+  return res;
+}
 
-  for (int i = n - 1; i > 0; i--) {
-    std::cerr << i << "\n";
-    while (true) {
-      if (std::abs(cur_A[i][i - 1]) < EPS) {
-        lambdas[i] = cur_A[i][i];
-        break;
-      }
-      T shift = wilkinson_shift(cur_A[i - 1][i - 1], cur_A[i][i - 1], cur_A[i][i]);
-      auto [Q_new, R_new] = QR_givens_tridiagonalization(cur_A - identity(n) * shift, i + 1);// O(n^2)
-      cur_A = fast_multiplication(R_new, Q_new) + identity(n) * shift;
-      //cur_A = R_new * Q_new + identity(n) * shift;
+// Whether the off-diagonal e[i] may be dropped, splitting the matrix between i and i + 1.
+template<typename T>
+bool is_negligible(const SymTridiagonal<T> &A, int i, const double EPS) {
+  T e = std::abs(A.e[i]);
+  return e < EPS || e <= std::numeric_limits<T>::epsilon() * (std::abs(A.d[i]) + std::abs(A.d[i + 1]));
+}
+
+/*
+ * One implicit QR step with Wilkinson shift on the unreduced block [l, m] of A, in O(m - l):
+ * the first rotation is the one QR of (A - shift * I) would start with, the rest chase the
+ * resulting bulge down the band. If Z is given, it is multiplied by the rotations from the right.
+ */
+template<typename T>
+void implicit_qr_step(SymTridiagonal<T> &A, int l, int m, Matrix<T> *Z = nullptr) {
+  auto &d = A.d;
+  auto &e = A.e;
+  T shift = wilkinson_shift(d[m - 1], e[m - 1], d[m]);
+  T x = d[l] - shift, z = e[l];
+  for (int k = l; k < m; k++) {
+    T r = std::hypot(x, z);
+    T c = (r == 0 ? T(1) : x / r), s = (r == 0 ? T(0) : z / r);
+    if (k > l) {
+      e[k - 1] = r;
+    }
+    T dk = d[k], dk1 = d[k + 1], ek = e[k];
+    d[k] = c * c * dk + 2 * c * s * ek + s * s * dk1;
+    d[k + 1] = s * s * dk - 2 * c * s * ek + c * c * dk1;
+    e[k] = c * s * (dk1 - dk) + (c * c - s * s) * ek;
+    if (k + 1 < m) {
+      x = e[k];
+      z = s * e[k + 1];// the bulge at (k, k + 2)
+      e[k + 1] *= c;
+    }
+    if (Z) {
+      rotate_columns(*Z, GivensMatrix(k, k + 1, -s, c));
+    }
+  }
+}
 
-      if (needQ) {
-        Q *= Q_new;
+/*
+ * Diagonalizes A in place by implicit shifted QR with deflation: on success A.d holds the
+ * eigenvalues (unordered) and Z, if given, is multiplied from the right by the rotations.
+ * Returns false if some eigenvalue takes more than LIMIT steps. An observer sees every QR step
+ * with the subdiagonal element being driven to zero, and every deflation.
+ */
+template<typename T>
+bool tridiagonal_qr(SymTridiagonal<T> &A, Matrix<T> *Z, const double EPS,
+                    SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  Telemetry telemetry(report, observer);
+  int steps = 0;
+  T neglected = 0;
+  for (int i = A.n - 1; i > 0; i--) {
+    for (int iter = 0; !is_negligible(A, i - 1, EPS); iter++) {
+      if (iter == LIMIT) {
+        telemetry.stop(StopReason::iteration_limit, steps, std::abs(A.e[i - 1]));
+        return false;
+      }
+      int l = i - 1;
+      while (l > 0 && !is_negligible(A, l - 1, EPS)) {
+        l--;
       }
+      implicit_qr_step(A, l, i, Z);
+      telemetry.step(++steps, std::abs(A.e[i - 1]));
     }
+    neglected = std::max(neglected, std::abs(A.e[i - 1]));
+    A.e[i - 1] = 0;
+    telemetry.deflation(i, steps);
   }
-  lambdas[0] = cur_A[0][0];
+  telemetry.stop(StopReason::converged, steps, neglected);
+  return true;
+}
 
-  return std::optional(make_pair(lambdas, Q));
+/*
+ * Eigenvalues (and, if needQ, eigenvectors Q with A = Q * diag * Q^T) of a symmetric tridiagonal
+ * matrix by implicit shifted QR with deflation. Without Q this takes O(n^2) time and O(n) memory;
+ * the returned Q is then an empty matrix.
+ */
+template<typename T>
+std::optional<std::pair<std::vector<T>, Matrix<T>>> eigen_qr_shift(SymTridiagonal<T> A, bool needQ = 0, const double EPS = 1e-3,
+                                                                   SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  Matrix<T> Q = (needQ ? identity<T>(A.n) : Matrix<T>(0));
+  if (!tridiagonal_qr(A, needQ ? &Q : nullptr, EPS, report, observer)) {
+    return std::nullopt;
+  }
+  return std::optional(make_pair(A.d, Q));
+}
+
+template<typename T>
+std::optional<std::pair<std::vector<T>, Matrix<T>>> eigen_qr_shift(const Matrix<T> &A, bool needQ = 0, const double EPS = 1e-3,
+                                                                   SolverReport *report = nullptr, SolverObserver *observer = nullptr) {// A should be tridiagonalized
+  return eigen_qr_shift(SymTridiagonal<T>(A), needQ, EPS, report, observer);
 }
 
 }
@@ -6,6 +6,7 @@
 #define LINEAR_METHODS_EIGEN_SIMPLE_ITERATION_HPP_
 
 #include "../core/matrix.hpp"
+#include "../core/report.hpp"
 #include "../core/util.hpp"
 
 #include <optional>
@@ -15,21 +16,33 @@ namespace Linear {
 
 extern const int LIMIT;
 
-template<class T>
-std::optional<std::pair<std::vector<T>, T>> eigen_simple_iteration(const Matrix<T> &A, const double EPS = 1e-3) {
+/*
+ * Power iteration. A is any matrix with n and operator*(std::vector), e.g. a Matrix<T, N> or an
+ * out-of-core TiledMatrix<T>; every iteration costs one product, reused for the Rayleigh quotient,
+ * the residual and the next vector.
+ */
+template<class M, class T = typename M::value_type>
+std::optional<std::pair<std::vector<T>, T>> eigen_simple_iteration(const M &A, const double EPS = 1e-3,
+                                                                   SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
   int n = A.n;
 
   auto v = normalize(random_vector<T>(n));
 
-  int increase = 0;
-  for (int iter = 0; iter < LIMIT; iter++) {
-    v = normalize(A * v);
-    T lambda = scalar(v, A * v);
-
-    if (abs(A * v - v * lambda) < EPS) {
-      return std::optional(make_pair(v, lambda));
+  Telemetry telemetry(report, observer);
+  T res = 0;
+  for (int iter = 1; iter <= LIMIT; iter++) {
+    std::vector<T> Av = A * v;
+    T lambda = scalar(v, Av);
+
+    res = abs(Av - v * lambda);
+    telemetry.step(iter, res);
+    if (res < EPS) {
+      telemetry.stop(StopReason::converged, iter, res);
+      return std::optional(std::make_pair(v, lambda));
     }
+    v = normalize(std::move(Av));
   }
+  telemetry.stop(StopReason::iteration_limit, LIMIT, res);
   return std::nullopt;
 }
 
@@ -7,6 +7,8 @@
 
 #include "../core/matrix.hpp"
 #include "../core/util.hpp"
+#include "../core/vec.hpp"
+#include "../core/workspace.hpp"
 
 #include <optional>
 #include <random>
@@ -27,38 +29,251 @@ struct GivensMatrix {
   }
 };
 
+/*
+ * In-place rotation kernels. G acts on the pair (x, y) = (row i, row j) as
+ * x' = c * x + s * y, y' = -s * x + c * y; passing -s applies G^T instead.
+ */
+
 template<typename T>
-Matrix<T> operator *(const GivensMatrix &G, const Matrix<T> &A) {
-  Matrix<T> new_A = A;
-  new_A[G.i] = A[G.i] * G.c + A[G.j] * G.s;
-  new_A[G.j] = -A[G.i] * G.s + A[G.j] * G.c;
+void rotate(T *x, T *y, int len, T c, T s) {
+  for (int k = 0; k < len; k++) {
+    const T xk = x[k], yk = y[k];
+    x[k] = xk * c + yk * s;
+    y[k] = -xk * s + yk * c;
+  }
+}
+
+// A := G * A restricted to columns [from, to).
+template<typename T, int N>
+void rotate_rows(Matrix<T, N> &A, const GivensMatrix &G, int from = 0, int to = -1) {
+  if (G.i == G.j) {
+    return;
+  }
+  to = (to == -1 ? A.n : to);
+  rotate(A.row_data(G.i) + from, A.row_data(G.j) + from, to - from, T(G.c), T(G.s));
+}
+
+// A := A * G^T restricted to rows [from, to).
+template<typename T, int N>
+void rotate_columns(Matrix<T, N> &A, const GivensMatrix &G, int from = 0, int to = -1) {
+  if (G.i == G.j) {
+    return;
+  }
+  to = (to == -1 ? A.n : to);
+  const T c = G.c, s = G.s;
+  for (int r = from; r < to; r++) {
+    T *row = A.row_data(r);
+    const T x = row[G.i], y = row[G.j];
+    row[G.i] = x * c + y * s;
+    row[G.j] = -x * s + y * c;
+  }
+}
+
+template<typename T, int N>
+Matrix<T, N> operator *(const GivensMatrix &G, const Matrix<T, N> &A) {
+  Matrix<T, N> new_A = A;
+  rotate_rows(new_A, G);
   return new_A;
 }
 
+/*
+ * Orthogonal matrix Q = G_1^T * G_2^T * ... * G_k^T kept as the list of its rotations,
+ * so that Q^T * A = G_k * ... * G_1 * A. Products with Q cost O(n) per rotation and
+ * Q is only built explicitly by to_matrix().
+ * For a fixed size N the rotations are kept in place: QR of an N x N matrix needs at most N * (N + 1) / 2.
+ * Otherwise they are in a vector that takes its memory from the workspace, if one is given.
+ */
+template<typename T, int N = DYNAMIC>
+struct GivensSequence {
+  using Rotations = std::conditional_t<N == DYNAMIC, std::vector<GivensMatrix, WorkspaceAllocator<GivensMatrix>>,
+                                       StaticVector<GivensMatrix, size_t(N) * (N + 1) / 2>>;
 
-template<typename T>
-std::pair<Matrix<T>, Matrix<T>> QR_givens(const Matrix<T> &A) {
-  int n = A.n;
-  Matrix<T> A0 = A;
-  Matrix<T> Q = identity(n);
+  int n;
+  Rotations rotations;
+
+  explicit GivensSequence(int n, Workspace *workspace = nullptr) : n(n), rotations(make_rotations(workspace)) {
+  }
+
+  void push(const GivensMatrix &G) {
+    if (G.i != G.j) {
+      rotations.push_back(G);
+    }
+  }
+
+  size_t size() const {
+    return rotations.size();
+  }
+
+  // Drops the rotations but keeps their memory for the next decomposition.
+  void clear() {
+    rotations.clear();
+  }
+
+  // A := Q^T * A
+  void apply_transpose(Matrix<T, N> &A) const {
+    apply_rows(A, false);
+  }
+
+  // A := Q * A
+  void apply(Matrix<T, N> &A) const {
+    apply_rows(A, true);
+  }
+
+  // A := A * Q
+  void apply_right(Matrix<T, N> &A) const {
+    check(A.n);
+    parallel_for(0, A.n, (long long) A.n * rotations.size(), [&](int lo, int hi) {
+      for (int r = lo; r < hi; r++) {
+        T *row = A.row_data(r);// one row stays in L1 while every rotation passes over it
+        for (const auto &G : rotations) {
+          const T x = row[G.i], y = row[G.j];
+          row[G.i] = x * T(G.c) + y * T(G.s);
+          row[G.j] = -x * T(G.s) + y * T(G.c);
+        }
+      }
+    });
+  }
+
+  // v := Q^T * v
+  void apply_transpose(std::vector<T> &v) const {
+    check(v.size());
+    for (const auto &G : rotations) {
+      rotate(&v[G.i], &v[G.j], 1, T(G.c), T(G.s));
+    }
+  }
+
+  // v := Q * v
+  void apply(std::vector<T> &v) const {
+    check(v.size());
+    for (auto it = rotations.rbegin(); it != rotations.rend(); it++) {
+      rotate(&v[it->i], &v[it->j], 1, T(it->c), T(-it->s));
+    }
+  }
+
+  Matrix<T, N> to_matrix() const {
+    Matrix<T, N> Q = identity<T, N>(n);
+    apply(Q);
+    return Q;
+  }
+
+  operator Matrix<T, N>() const {
+    return to_matrix();
+  }
+
+ private:
+  static Rotations make_rotations([[maybe_unused]] Workspace *workspace) {
+    if constexpr (N == DYNAMIC) {
+      return Rotations(WorkspaceAllocator<GivensMatrix>(workspace));
+    } else {
+      return Rotations();
+    }
+  }
+
+  void check(size_t m) const {
+    if (m != size_t(n)) {
+      throw std::runtime_error("Matrices have different sizes!");
+    }
+  }
+
+  /*
+   * Row rotations are applied in waves over blocks of COLUMN_BLOCK columns: the slice of A
+   * a block covers stays in cache while all rotations sweep over it, and blocks are independent.
+   */
+  void apply_rows(Matrix<T, N> &A, bool transposed) const {
+    check(A.n);
+    const int COLUMN_BLOCK = 64;
+    const int blocks = (A.n + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+    parallel_for(0, blocks, (long long) A.n * rotations.size(), [&](int lo, int hi) {
+      for (int b = lo; b < hi; b++) {
+        const int from = b * COLUMN_BLOCK, len = std::min(A.n, from + COLUMN_BLOCK) - from;
+        if (transposed) {
+          for (auto it = rotations.rbegin(); it != rotations.rend(); it++) {
+            rotate(A.row_data(it->i) + from, A.row_data(it->j) + from, len, T(it->c), T(-it->s));
+          }
+        } else {
+          for (const auto &G : rotations) {
+            rotate(A.row_data(G.i) + from, A.row_data(G.j) + from, len, T(G.c), T(G.s));
+          }
+        }
+      }
+    });
+  }
+};
+
+template<typename T, int N>
+Matrix<T, N> operator *(const Matrix<T, N> &A, const GivensSequence<T, N> &Q) {
+  Matrix<T, N> res = A;
+  Q.apply_right(res);
+  return res;
+}
+
+template<typename T, int N>
+Matrix<T, N> operator *(const GivensSequence<T, N> &Q, const Matrix<T, N> &A) {
+  Matrix<T, N> res = A;
+  Q.apply(res);
+  return res;
+}
+
+template<typename T, int N>
+std::vector<T> operator *(const GivensSequence<T, N> &Q, const std::vector<T> &v) {
+  std::vector<T> res = v;
+  Q.apply(res);
+  return res;
+}
+
+template<typename T, int N>
+Matrix<T, N> &operator *=(Matrix<T, N> &A, const GivensSequence<T, N> &Q) {
+  Q.apply_right(A);
+  return A;
+}
+
+template<typename T, int N>
+std::ostream &operator<<(std::ostream &out, const GivensSequence<T, N> &Q) {
+  return out << Q.to_matrix();
+}
+
+/*
+ * R := the R factor of R and Q := its Q in implicit form, reusing the memory of both:
+ * iterative methods that factor a new matrix every step allocate nothing after the first one.
+ */
+template<typename T, int N>
+void QR_givens_in_place(Matrix<T, N> &R, GivensSequence<T, N> &Q) {
+  int n = R.n;
+  if (Q.n != n) {
+    throw std::runtime_error("Matrices have different sizes!");
+  }
+  Q.clear();
   for (int c = 0; c < n; c++) {
     int r = c;
-    while (r < n && is_zero(A0[r][c])) {
+    while (r < n && is_zero(R[r][c])) {
       r++;
     }
     if (r == n) {
       continue;
     }
     for (int i = r + 1; i < n; i++) {
-      GivensMatrix G(i, r, A0[i][c], A0[r][c]);
-      A0 = G * A0;
-      Q = G * Q;
+      GivensMatrix G(i, r, R[i][c], R[r][c]);
+      rotate_rows(R, G, c);
+      R[i][c] = 0;
+      Q.push(G);
     }
     GivensMatrix G(r, c, 1, 0);
-    A0 = G * A0;
-    Q = G * Q;
+    rotate_rows(R, G, c);
+    Q.push(G);
   }
-  return {Q.transpose(), A0};
+}
+
+/*
+ * QR decomposition by Givens rotations, applied in place to the rows of R.
+ * Q is returned in implicit form; use Q.to_matrix() for the explicit matrix.
+ * For a fixed-size Matrix<T, N> nothing is allocated on the heap.
+ */
+template<typename T, int N>
+std::pair<GivensSequence<T, N>, Matrix<T, N>> QR_givens(const Matrix<T, N> &A) {
+  Matrix<T, N> R = A;
+  GivensSequence<T, N> Q(A.n);
+  QR_givens_in_place(R, Q);
+  return {std::move(Q), std::move(R)};
 }
 
 }
@@ -8,6 +8,7 @@
 #include "../core/matrix.hpp"
 #include "../core/util.hpp"
 
+#include <array>
 #include <optional>
 #include <random>
 
@@ -28,31 +29,298 @@ struct HouseholderMatrix {
 };
 
 template<typename T>
-Matrix<T> operator *(const HouseholderMatrix<T> &H, const Matrix<T> &A) {
-  Matrix<T> new_A = A - mult(H.v * 2.0, (A.transpose() * H.v));
+Matrix<T> operator *(const HouseholderMatrix<T> &H, const Matrix<T> &A) { // A - 2 v (v^T A), no n x n temporaries
+  int n = A.n;
+  std::vector<T> w(n);
+  for (int i = 0; i < n; i++) {
+    const T *a_i = A.row_data(i);
+    for (int j = 0; j < n; j++) {
+      w[j] += H.v[i] * a_i[j];
+    }
+  }
+  Matrix<T> new_A = A;
+  for (int i = 0; i < n; i++) {
+    T *a_i = new_A.row_data(i);
+    const T k = 2 * H.v[i];
+    for (int j = 0; j < n; j++) {
+      a_i[j] -= k * w[j];
+    }
+  }
   return new_A;
 }
 
+/*
+ * Builds the reflector H = I - tau * v * v^T, v = (1, x[1] / v0, ...), with H * x = (beta, 0, ..., 0)
+ * and beta = |x| >= 0. x (m elements, stride inc) is overwritten by (beta, v[1], ..., v[m - 1]).
+ */
+template<typename T>
+T make_reflector(int m, T *x, int inc) {
+  T scale = 0;// everything below works on x / scale so that squares neither underflow nor overflow
+  for (int i = 0; i < m; i++) {
+    scale = std::max(scale, std::abs(x[size_t(i) * inc]));
+  }
+  if (scale == 0) {
+    return 0;
+  }
+  T alpha = x[0] / scale;
+  T sigma = 0;
+  for (int i = 1; i < m; i++) {
+    T xi = x[size_t(i) * inc] / scale;
+    sigma += xi * xi;
+  }
+  if (sigma == 0 && alpha >= 0) {
+    return 0;
+  }
+  T beta = std::sqrt(alpha * alpha + sigma);
+  T v0 = (alpha <= 0 ? alpha - beta : -sigma / (alpha + beta));
+  for (int i = 1; i < m; i++) {
+    x[size_t(i) * inc] = x[size_t(i) * inc] / scale / v0;
+  }
+  x[0] = beta * scale;
+  return 2 * v0 * v0 / (v0 * v0 + sigma);
+}
+
+/*
+ * Triangular factor of the compact WY form: H_0 * ... * H_{k-1} = I - V * Tf * V^T
+ * for the m x k unit lower trapezoidal V (row-major, leading dimension k).
+ */
+template<typename T>
+std::vector<T> block_reflector_factor(int m, int k, const T *V, const T *tau) {
+  std::vector<T> Tf(size_t(k) * k), w(k);
+  for (int i = 0; i < k; i++) {
+    std::fill(w.begin(), w.begin() + i, T(0));
+    for (int r = i; r < m; r++) { // V(:, 0:i)^T * v_i, v_i is zero above row i
+      const T v_ri = V[size_t(r) * k + i];
+      for (int j = 0; j < i; j++) {
+        w[j] += V[size_t(r) * k + j] * v_ri;
+      }
+    }
+    for (int j = 0; j < i; j++) {
+      T sum = 0;
+      for (int l = j; l < i; l++) {
+        sum += Tf[size_t(j) * k + l] * w[l];
+      }
+      Tf[size_t(j) * k + i] = -tau[i] * sum;
+    }
+    Tf[size_t(i) * k + i] = tau[i];
+  }
+  return Tf;
+}
+
+/*
+ * C := (I - V * Tf * V^T) * C, or its transpose when `transpose` is set, for an m x nc block C.
+ * Done as three level-3 steps: W = V^T * C, W = Tf * W (or Tf^T * W), C -= V * W.
+ */
+template<typename T>
+void apply_block_reflector(int m, int nc, int k, const T *V, const T *Tf, T *C, int ldc, bool transpose) {
+  if (nc <= 0 || k <= 0) {
+    return;
+  }
+  std::vector<T> Vt(size_t(k) * m), W(size_t(k) * nc), TW(size_t(k) * nc);
+  for (int r = 0; r < m; r++) {
+    for (int j = 0; j < k; j++) {
+      Vt[size_t(j) * m + r] = V[size_t(r) * k + j];
+    }
+  }
+  gemm(k, nc, m, T(1), Vt.data(), m, C, ldc, T(0), W.data(), nc);
+  for (int i = 0; i < k; i++) {
+    T *tw_i = TW.data() + size_t(i) * nc;
+    // row i of Tf (upper) or of Tf^T (lower)
+    const int from = (transpose ? 0 : i), to = (transpose ? i + 1 : k);
+    for (int l = from; l < to; l++) {
+      const T t = (transpose ? Tf[size_t(l) * k + i] : Tf[size_t(i) * k + l]);
+      const T *w_l = W.data() + size_t(l) * nc;
+      for (int j = 0; j < nc; j++) {
+        tw_i[j] += t * w_l[j];
+      }
+    }
+  }
+  gemm(m, nc, k, T(-1), V, k, TW.data(), nc, T(1), C, ldc);
+}
+
+/*
+ * Householder QR in compact form: R on and above the diagonal of `qr`, the essential part of
+ * reflector j below the diagonal in column j, Q = H_0 * H_1 * ... * H_{n-1}.
+ */
+template<typename T>
+struct HouseholderQR {
+  Matrix<T> qr;
+  std::vector<T> tau;
+  int block;
+
+  HouseholderQR(const Matrix<T> &A, int block) : qr(A), tau(A.n), block(std::max(block, 1)) {
+  }
+
+  int size() const {
+    return qr.n;
+  }
+
+  Matrix<T> R() const {
+    int n = qr.n;
+    Matrix<T> res(n);
+    for (int i = 0; i < n; i++) {
+      for (int j = i; j < n; j++) {
+        res[i][j] = qr[i][j];
+      }
+    }
+    return res;
+  }
 
+  Matrix<T> Q() const {
+    Matrix<T> res = identity<T>(qr.n);
+    apply_q(res);
+    return res;
+  }
+
+  // C := Q^T * C
+  void apply_qt(Matrix<T> &C) const {
+    for (int j0 = 0; j0 < qr.n; j0 += block) {
+      apply_panel(C, j0, true);
+    }
+  }
+
+  // C := Q * C
+  void apply_q(Matrix<T> &C) const {
+    for (int j0 = (qr.n - 1) / block * block; j0 >= 0; j0 -= block) {
+      apply_panel(C, j0, false);
+    }
+  }
+
+  // x := Q^T * x
+  void apply_qt(std::vector<T> &x) const {
+    for (int j = 0; j < qr.n; j++) {
+      apply_reflector(x, j);
+    }
+  }
+
+  // x := Q * x
+  void apply_q(std::vector<T> &x) const {
+    for (int j = qr.n - 1; j >= 0; j--) {
+      apply_reflector(x, j);
+    }
+  }
+
+  // Rows j0.. of the panel starting at column j0, unit diagonal and zeros above it made explicit.
+  std::vector<T> panel(int j0, int jb) const {
+    int m = qr.n - j0;
+    std::vector<T> V(size_t(m) * jb);
+    for (int r = 0; r < m; r++) {
+      for (int j = 0; j < jb && j <= r; j++) {
+        V[size_t(r) * jb + j] = (r == j ? T(1) : qr[j0 + r][j0 + j]);
+      }
+    }
+    return V;
+  }
+
+ private:
+  void apply_panel(Matrix<T> &C, int j0, bool transpose) const {
+    if (C.n != qr.n) {
+      throw std::runtime_error("Matrices have different sizes!");
+    }
+    int jb = std::min(block, qr.n - j0), m = qr.n - j0;
+    auto V = panel(j0, jb);
+    auto Tf = block_reflector_factor(m, jb, V.data(), tau.data() + j0);
+    apply_block_reflector(m, C.n, jb, V.data(), Tf.data(), C.row_data(j0), C.stride(), transpose);
+  }
+
+  void apply_reflector(std::vector<T> &x, int j) const {
+    if (tau[j] == 0) {
+      return;
+    }
+    T w = x[j];
+    for (int i = j + 1; i < qr.n; i++) {
+      w += qr[i][j] * x[i];
+    }
+    w *= tau[j];
+    x[j] -= w;
+    for (int i = j + 1; i < qr.n; i++) {
+      x[i] -= w * qr[i][j];
+    }
+  }
+};
+
+/*
+ * Blocked Householder QR. Each panel of `block` columns is factored column by column, then its
+ * reflectors are applied to the trailing columns at once as I - V * Tf^T * V^T through GEMM.
+ */
 template<typename T>
-std::pair<Matrix<T>, Matrix<T>> QR_householder(const Matrix<T> &A) {
+HouseholderQR<T> QR_householder_blocked(const Matrix<T> &A, int block = 32) {
+  HouseholderQR<T> F(A, block);
   int n = A.n;
-  Matrix<T> A0 = A;
-  Matrix<T> Q = identity(n);
-  for (int c = 0; c < n; c++) {
-    std::vector<T> v(n);
-    for (int i = c; i < n; i++) {
-      v[i] = A0[i][c];
+  Matrix<T> &a = F.qr;
+  std::vector<T> w(n);
+  for (int j0 = 0; j0 < n; j0 += F.block) {
+    int jb = std::min(F.block, n - j0), j1 = j0 + jb;
+    for (int j = j0; j < j1; j++) {
+      T tau = F.tau[j] = make_reflector(n - j, a.row_data(j) + j, a.stride());
+      if (tau == 0 || j + 1 == j1) {
+        continue;
+      }
+      // w = v^T * A(j:, j+1:j1), then A(j:, j+1:j1) -= tau * v * w
+      std::fill(w.begin() + j + 1, w.begin() + j1, T(0));
+      for (int i = j; i < n; i++) {
+        const T v_i = (i == j ? T(1) : a[i][j]);
+        const T *a_i = a.row_data(i);
+        for (int k = j + 1; k < j1; k++) {
+          w[k] += v_i * a_i[k];
+        }
+      }
+      for (int i = j; i < n; i++) {
+        const T v_i = tau * (i == j ? T(1) : a[i][j]);
+        T *a_i = a.row_data(i);
+        for (int k = j + 1; k < j1; k++) {
+          a_i[k] -= v_i * w[k];
+        }
+      }
     }
-    if (is_zero(v)) {
-      continue;
+    if (j1 < n) {
+      int m = n - j0;
+      auto V = F.panel(j0, jb);
+      auto Tf = block_reflector_factor(m, jb, V.data(), F.tau.data() + j0);
+      apply_block_reflector(m, n - j1, jb, V.data(), Tf.data(), a.row_data(j0) + j1, a.stride(), true);
     }
+  }
+  return F;
+}
 
-    HouseholderMatrix H(v, c);
-    A0 = H * A0;
-    Q = H * Q;
+/*
+ * A = Q * R; returns {Q, R}. A Matrix<T> goes through QR_householder_blocked; a fixed-size
+ * Matrix<T, N> is factored column by column in place, without heap allocation.
+ */
+template<typename T, int N>
+std::pair<Matrix<T, N>, Matrix<T, N>> QR_householder(const Matrix<T, N> &A) {
+  if constexpr (N == DYNAMIC) {
+    auto F = QR_householder_blocked(A);
+    return {F.Q(), F.R()};
+  } else {
+    Matrix<T, N> R = A, Q = identity<T, N>();
+    std::array<T, N> tau{};
+    // H * C = C - tau * v * (v^T * C) on rows j.. and columns [from, N) of C, v = (1, R[j + 1][j], ...)
+    auto reflect = [&](Matrix<T, N> &C, int j, int from) {
+      for (int k = from; k < N; k++) {
+        T w = C[j][k];
+        for (int i = j + 1; i < N; i++) {
+          w += R[i][j] * C[i][k];
+        }
+        w *= tau[j];
+        C[j][k] -= w;
+        for (int i = j + 1; i < N; i++) {
+          C[i][k] -= w * R[i][j];
+        }
+      }
+    };
+    for (int j = 0; j < N; j++) {
+      tau[j] = make_reflector(N - j, R.row_data(j) + j, N);
+      reflect(R, j, j + 1);
+    }
+    for (int j = N - 1; j >= 0; j--) {
+      reflect(Q, j, j);
+    }
+    for (int i = 1; i < N; i++) {
+      std::fill(R.row_data(i), R.row_data(i) + i, T(0));
+    }
+    return {Q, R};
   }
-  return {Q.transpose(), A0};
 }
 
 }
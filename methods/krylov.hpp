@@ -0,0 +1,296 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_METHODS_KRYLOV_HPP_
+#define LINEAR_METHODS_KRYLOV_HPP_
+
+#include "../core/matrix.hpp"
+#include "../core/report.hpp"
+#include "../core/sparse_matrix.hpp"
+#include "../core/util.hpp"
+
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Linear {
+
+extern const int LIMIT;
+
+/*
+ * Krylov solvers for A * x = b with A given by op(x, y): y = A * x (pointers to n = b.size() elements),
+ * or by a Matrix / SparseMatrix. They start from x = 0, stop when |b - A * x| < EPS and return nullopt
+ * after LIMIT iterations (one matvec each) or on breakdown. The residual is tracked by the recurrences;
+ * on convergence it is confirmed by computing b - A * x. If `report` is given, it is filled in;
+ * an observer sees the recurrence residual of every iteration.
+ */
+
+template<typename T, typename Op>
+std::vector<T> residual(Op &op, const std::vector<T> &b, const std::vector<T> &x) {
+  std::vector<T> r(b.size());
+  op(x.data(), r.data());
+  for (size_t i = 0; i < b.size(); i++) {
+    r[i] = b[i] - r[i];
+  }
+  return r;
+}
+
+
+/*
+ * Conjugate gradient; A must be symmetric positive definite (nullopt if p^T * A * p <= 0 shows it is not).
+ * If the recursive residual has drifted from the true one, CG restarts from the true residual.
+ */
+template<typename T, typename Op, std::enable_if_t<std::is_invocable_v<Op &, const T *, T *>, int> = 0>
+std::optional<std::vector<T>> cg(Op &&op, const std::vector<T> &b, const double EPS = 1e-3,
+                                 SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  int n = b.size();
+  std::vector<T> x(n), r = b, p = r, q(n);
+  T rr = scalar(r, r);
+  Telemetry telemetry(report, observer);
+  for (int iter = 0; iter < LIMIT; iter++) {
+    if (std::sqrt(rr) < EPS) {
+      auto true_r = residual(op, b, x);
+      if (abs(true_r) < EPS) {
+        telemetry.stop(StopReason::converged, iter, abs(true_r));
+        return std::optional(x);
+      }
+      r = std::move(true_r);
+      p = r;
+      rr = scalar(r, r);
+    }
+    op(p.data(), q.data());
+    T pq = scalar(p, q);
+    if (!(pq > 0)) {
+      telemetry.stop(StopReason::breakdown, iter, abs(residual(op, b, x)));
+      return std::nullopt;
+    }
+    T alpha = rr / pq;
+    x += p * alpha;
+    r -= q * alpha;
+    T rr_new = scalar(r, r);
+    p = r + p * (rr_new / rr);
+    rr = rr_new;
+    telemetry.step(iter + 1, std::sqrt(rr));
+  }
+  auto true_r = residual(op, b, x);
+  const bool converged = abs(true_r) < EPS;
+  telemetry.stop(converged ? StopReason::converged : StopReason::iteration_limit, LIMIT, abs(true_r));
+  if (converged) {
+    return std::optional(x);
+  }
+  return std::nullopt;
+}
+
+/*
+ * MINRES (Paige, Saunders) for symmetric, possibly indefinite A: minimizes |b - A * x| over the
+ * Krylov subspace using the Lanczos three-term recurrence and Givens rotations, in O(n) memory.
+ */
+template<typename T, typename Op, std::enable_if_t<std::is_invocable_v<Op &, const T *, T *>, int> = 0>
+std::optional<std::vector<T>> minres(Op &&op, const std::vector<T> &b, const double EPS = 1e-3,
+                                     SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  int n = b.size();
+  std::vector<T> x(n), r1 = b, r2 = b, y = b, v(n), w(n), w1(n), w2(n);
+  T beta = abs(b), old_beta = 0;
+  T dbar = 0, epsilon = 0, phibar = beta;
+  T cs = -1, sn = 0;
+  const T tiny = std::numeric_limits<T>::epsilon();
+  Telemetry telemetry(report, observer);
+  int iter = 0;
+  StopReason reason = StopReason::iteration_limit;
+  for (; iter < LIMIT; iter++) {
+    if (phibar < EPS) {
+      auto true_r = residual(op, b, x);
+      if (abs(true_r) < EPS) {
+        telemetry.stop(StopReason::converged, iter, abs(true_r));
+        return std::optional(x);
+      }
+    }
+    if (beta == 0) {// the Krylov subspace is invariant and x is the best it has
+      reason = StopReason::breakdown;
+      break;
+    }
+    for (int i = 0; i < n; i++) {
+      v[i] = y[i] / beta;
+    }
+    op(v.data(), y.data());
+    if (iter > 0) {
+      y -= r1 * (beta / old_beta);
+    }
+    T alpha = scalar(v, y);
+    y -= r2 * (alpha / beta);
+    std::swap(r1, r2);
+    r2 = y;
+    old_beta = beta;
+    beta = abs(r2);
+
+    T old_epsilon = epsilon;
+    T delta = cs * dbar + sn * alpha;
+    T gbar = sn * dbar - cs * alpha;
+    epsilon = sn * beta;
+    dbar = -cs * beta;
+    T gamma = std::max(std::hypot(gbar, beta), tiny);
+    cs = gbar / gamma;
+    sn = beta / gamma;
+    T phi = cs * phibar;
+    phibar = sn * phibar;
+
+    std::swap(w1, w2);
+    std::swap(w2, w);// w1, w2 = previous two directions
+    for (int i = 0; i < n; i++) {
+      w[i] = (v[i] - old_epsilon * w1[i] - delta * w2[i]) / gamma;
+      x[i] += phi * w[i];
+    }
+    telemetry.step(iter + 1, phibar);
+  }
+  auto true_r = residual(op, b, x);
+  const bool converged = abs(true_r) < EPS;
+  telemetry.stop(converged ? StopReason::converged : reason, iter, abs(true_r));
+  if (converged) {
+    return std::optional(x);
+  }
+  return std::nullopt;
+}
+
+/*
+ * GMRES(m) for a general A: Arnoldi with modified Gram-Schmidt builds up to m basis vectors,
+ * the Hessenberg least squares problem is kept triangular by Givens rotations, then the method
+ * restarts from the current x. Memory O(n * m).
+ */
+template<typename T, typename Op, std::enable_if_t<std::is_invocable_v<Op &, const T *, T *>, int> = 0>
+std::optional<std::vector<T>> gmres(Op &&op, const std::vector<T> &b, int m = 30, const double EPS = 1e-3,
+                                    SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  int n = b.size();
+  m = std::max(1, std::min(m, n));
+  std::vector<T> x(n);
+  std::vector<std::vector<T>> V(m + 1, std::vector<T>(n));
+  std::vector<std::vector<T>> H(m, std::vector<T>(m + 1));// H[j] is column j
+  std::vector<T> cs(m), sn(m), g(m + 1);
+  Telemetry telemetry(report, observer);
+  int iter = 0;
+  while (true) {
+    auto r = residual(op, b, x);
+    T beta = abs(r);
+    if (beta < EPS || iter >= LIMIT) {
+      telemetry.stop(beta < EPS ? StopReason::converged : StopReason::iteration_limit, iter, beta);
+      return (beta < EPS ? std::optional(x) : std::nullopt);
+    }
+    for (int i = 0; i < n; i++) {
+      V[0][i] = r[i] / beta;
+    }
+    std::fill(g.begin(), g.end(), T(0));
+    g[0] = beta;
+
+    int k = 0;
+    for (int j = 0; j < m && iter < LIMIT; j++) {
+      iter++;
+      std::vector<T> &w = V[j + 1];
+      op(V[j].data(), w.data());
+      for (int i = 0; i <= j; i++) {
+        H[j][i] = scalar(w, V[i]);
+        w -= V[i] * H[j][i];
+      }
+      const T next = H[j][j + 1] = abs(w);
+      if (next != 0) {
+        w *= T(1) / next;
+      }
+      for (int i = 0; i < j; i++) {
+        T t = cs[i] * H[j][i] + sn[i] * H[j][i + 1];
+        H[j][i + 1] = -sn[i] * H[j][i] + cs[i] * H[j][i + 1];
+        H[j][i] = t;
+      }
+      T rho = std::hypot(H[j][j], H[j][j + 1]);
+      if (rho == 0) {// A is singular on the subspace
+        break;
+      }
+      cs[j] = H[j][j] / rho;
+      sn[j] = H[j][j + 1] / rho;
+      H[j][j] = rho;
+      H[j][j + 1] = 0;
+      g[j + 1] = -sn[j] * g[j];
+      g[j] *= cs[j];
+      k = j + 1;
+      telemetry.step(iter, std::abs(g[j + 1]));
+      if (std::abs(g[j + 1]) < EPS || next == 0) {
+        break;
+      }
+    }
+    if (k == 0) {
+      telemetry.stop(StopReason::breakdown, iter, beta);
+      return std::nullopt;
+    }
+
+    // back substitution with the triangular H, then x += V * y
+    std::vector<T> y(k);
+    for (int i = k - 1; i >= 0; i--) {
+      T sum = g[i];
+      for (int j = i + 1; j < k; j++) {
+        sum -= H[j][i] * y[j];
+      }
+      y[i] = sum / H[i][i];
+    }
+    for (int j = 0; j < k; j++) {
+      x += V[j] * y[j];
+    }
+  }
+}
+
+template<typename T>
+std::optional<std::vector<T>> cg(const Matrix<T> &A, const std::vector<T> &b, const double EPS = 1e-3,
+                                 SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  if (!check_dimension(A, b)) {
+    throw std::runtime_error("Bad arguments!");
+  }
+  return cg([&A](const T *x, T *y) { A.matvec(x, y); }, b, EPS, report, observer);
+}
+
+template<typename T>
+std::optional<std::vector<T>> cg(const SparseMatrix<T> &A, const std::vector<T> &b, const double EPS = 1e-3,
+                                 SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  if (!check_dimension(A, b)) {
+    throw std::runtime_error("Bad arguments!");
+  }
+  return cg([&A](const T *x, T *y) { A.matvec(x, y); }, b, EPS, report, observer);
+}
+
+template<typename T>
+std::optional<std::vector<T>> minres(const Matrix<T> &A, const std::vector<T> &b, const double EPS = 1e-3,
+                                     SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  if (!check_dimension(A, b)) {
+    throw std::runtime_error("Bad arguments!");
+  }
+  return minres([&A](const T *x, T *y) { A.matvec(x, y); }, b, EPS, report, observer);
+}
+
+template<typename T>
+std::optional<std::vector<T>> minres(const SparseMatrix<T> &A, const std::vector<T> &b, const double EPS = 1e-3,
+                                     SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  if (!check_dimension(A, b)) {
+    throw std::runtime_error("Bad arguments!");
+  }
+  return minres([&A](const T *x, T *y) { A.matvec(x, y); }, b, EPS, report, observer);
+}
+
+template<typename T>
+std::optional<std::vector<T>> gmres(const Matrix<T> &A, const std::vector<T> &b, int m = 30, const double EPS = 1e-3,
+                                    SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  if (!check_dimension(A, b)) {
+    throw std::runtime_error("Bad arguments!");
+  }
+  return gmres([&A](const T *x, T *y) { A.matvec(x, y); }, b, m, EPS, report, observer);
+}
+
+template<typename T>
+std::optional<std::vector<T>> gmres(const SparseMatrix<T> &A, const std::vector<T> &b, int m = 30, const double EPS = 1e-3,
+                                    SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  if (!check_dimension(A, b)) {
+    throw std::runtime_error("Bad arguments!");
+  }
+  return gmres([&A](const T *x, T *y) { A.matvec(x, y); }, b, m, EPS, report, observer);
+}
+
+}
+
+#endif//LINEAR_METHODS_KRYLOV_HPP_
@@ -0,0 +1,228 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_METHODS_LANCZOS_HPP_
+#define LINEAR_METHODS_LANCZOS_HPP_
+
+#include "../core/matrix.hpp"
+#include "../core/sparse_matrix.hpp"
+#include "../core/sym_tridiagonal.hpp"
+#include "../core/thread_pool.hpp"
+#include "../core/util.hpp"
+#include "eigen_qr_shifts.hpp"
+#include "tridiagonalization.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+
+namespace Linear {
+
+extern const int LIMIT;
+
+// Which end of the spectrum an iterative eigensolver converges to.
+enum class Spectrum {
+  largest,
+  smallest,
+  both_ends// alternately the largest and the smallest: lambda_max, lambda_min, the second largest, ...
+};
+
+/*
+ * Full reorthogonalization of w against basis[0..count) by classical Gram-Schmidt done twice (CGS2).
+ * Returns the projection coefficients basis[i]^T * w of the original w.
+ */
+template<typename T>
+std::vector<T> reorthogonalize(const std::vector<std::vector<T>> &basis, int count, std::vector<T> &w) {
+  const int n = w.size();
+  std::vector<T> coefficients(count);
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<T> h(count);
+    parallel_for(0, count, (long long) count * n, [&](int lo, int hi) {
+      for (int i = lo; i < hi; i++) {
+        h[i] = std::inner_product(w.begin(), w.end(), basis[i].begin(), T(0));
+      }
+    });
+    parallel_for(0, n, (long long) count * n, [&](int lo, int hi) {
+      for (int i = 0; i < count; i++) {
+        const T *b = basis[i].data();
+        for (int r = lo; r < hi; r++) {
+          w[r] -= h[i] * b[r];
+        }
+      }
+    });
+    for (int i = 0; i < count; i++) {
+      coefficients[i] += h[i];
+    }
+  }
+  return coefficients;
+}
+
+/*
+ * Eigenvalues (ascending) and eigenvectors (columns) of a small dense symmetric matrix:
+ * tridiagonalization, then implicit QR on the tridiagonal matrix.
+ */
+template<typename T>
+std::optional<std::pair<std::vector<T>, Matrix<T>>> small_symmetric_eigen(const Matrix<T> &H) {
+  const int m = H.n;
+  auto [A, Q] = tridiagonalization(H);
+  SymTridiagonal<T> S(A);
+  if (!tridiagonal_qr(S, &Q, 0)) {
+    return std::nullopt;
+  }
+  std::vector<int> perm(m);
+  std::iota(perm.begin(), perm.end(), 0);
+  std::sort(perm.begin(), perm.end(), [&](int a, int b) { return S.d[a] < S.d[b]; });
+  std::vector<T> theta(m);
+  Matrix<T> Y(m);
+  for (int j = 0; j < m; j++) {
+    theta[j] = S.d[perm[j]];
+    for (int i = 0; i < m; i++) {
+      Y[i][j] = Q[i][perm[j]];
+    }
+  }
+  return std::optional(make_pair(theta, Y));
+}
+
+/*
+ * k extremal eigenpairs of a symmetric operator of size n given only by op(x, y): y = A * x
+ * (x and y are pointers to n elements). Thick-restart Lanczos (Wu, Simon) with full reorthogonalization:
+ * the basis grows to `basis` vectors (by default max(2k + 10, 20)), then the best Ritz vectors are
+ * kept and the basis is extended from them again. Stops when every wanted Ritz pair has residual
+ * |A * y - theta * y| <= EPS * max |theta|; returns nullopt after LIMIT restarts.
+ * Eigenvalues are returned in ascending order, eigenvectors normalized in the same order.
+ * A single start vector finds one copy of a multiple eigenvalue only.
+ */
+template<typename T, typename Op>
+std::optional<std::pair<std::vector<T>, std::vector<std::vector<T>>>>
+lanczos(int n, Op &&op, int k, Spectrum which = Spectrum::largest, const double EPS = 1e-8, int basis = 0) {
+  if (k < 1 || k > n) {
+    throw std::runtime_error("Bad number of eigenvalues!");
+  }
+  const int m = std::min(n, basis > 0 ? std::max(basis, k + 1) : std::max(2 * k + 10, 20));
+
+  // preference of the Ritz values sorted ascending: the first k are wanted, the first l are kept on restart
+  std::vector<int> order;
+  for (int lo = 0, hi = m - 1; lo <= hi;) {
+    if (which == Spectrum::smallest) {
+      order.push_back(lo++);
+    } else if (which == Spectrum::largest || order.size() % 2 == 0) {
+      order.push_back(hi--);
+    } else {
+      order.push_back(lo++);
+    }
+  }
+
+  std::mt19937 rnd(239);
+  std::uniform_real_distribution<T> dist(-1, 1);
+  auto random_direction = [&] {
+    std::vector<T> x(n);
+    std::generate(x.begin(), x.end(), [&] { return dist(rnd); });
+    return x;
+  };
+
+  std::vector<std::vector<T>> V(m + 1, std::vector<T>(n));
+  V[0] = normalize(random_direction());
+  Matrix<T> H(m);
+  int l = 0;
+  for (int restart = 0; restart < LIMIT; restart++) {
+    T beta = 0;
+    for (int j = l; j < m; j++) {
+      std::vector<T> &w = V[j + 1];
+      op(V[j].data(), w.data());
+      auto h = reorthogonalize(V, j + 1, w);
+      for (int i = 0; i <= j; i++) {
+        H[i][j] = H[j][i] = h[i];
+      }
+      T scale = 0;
+      for (int i = 0; i <= j; i++) {
+        scale = std::max(scale, std::abs(h[i]));
+      }
+      beta = abs(w);
+      if (beta <= 2 * std::numeric_limits<T>::epsilon() * scale) {
+        // invariant subspace: continue with any direction orthogonal to it, coupled by zero
+        beta = 0;
+        if (j + 1 < n) {
+          w = random_direction();
+          reorthogonalize(V, j + 1, w);
+          w = normalize(std::move(w));
+        }
+      } else {
+        for (auto &x : w) {
+          x /= beta;
+        }
+      }
+    }
+
+    auto ritz = small_symmetric_eigen(H);
+    if (!ritz) {
+      return std::nullopt;
+    }
+    auto &[theta, Y] = *ritz;
+    const T tol = EPS * std::max(std::abs(theta[0]), std::abs(theta[m - 1]));
+    std::vector<int> wanted(order.begin(), order.begin() + k);
+    std::sort(wanted.begin(), wanted.end());
+    bool converged = true;
+    for (int i : wanted) {
+      converged &= std::abs(beta * Y[m - 1][i]) <= tol;
+    }
+
+    const int keep = (converged ? k : std::max(1, std::min(m - 1, k + (m - k) / 2)));
+    std::vector<int> kept(order.begin(), order.begin() + keep);
+    if (converged) {
+      kept = wanted;
+    }
+    // Ritz vectors V_m * y_i
+    std::vector<std::vector<T>> U(keep, std::vector<T>(n));
+    parallel_for(0, n, 2LL * n * m * keep, [&](int lo, int hi) {
+      for (int i = 0; i < keep; i++) {
+        for (int j = 0; j < m; j++) {
+          const T y = Y[j][kept[i]];
+          const T *v = V[j].data();
+          T *u = U[i].data();
+          for (int r = lo; r < hi; r++) {
+            u[r] += y * v[r];
+          }
+        }
+      }
+    });
+
+    if (converged) {
+      std::vector<T> values;
+      for (int i : kept) {
+        values.push_back(theta[i]);
+      }
+      return std::optional(make_pair(values, U));
+    }
+
+    std::swap(V[keep], V[m]);
+    for (int i = 0; i < keep; i++) {
+      V[i] = std::move(U[i]);
+    }
+    H = Matrix<T>(m);
+    for (int i = 0; i < keep; i++) {
+      H[i][i] = theta[kept[i]];
+    }
+    l = keep;
+  }
+  return std::nullopt;
+}
+
+template<typename T>
+std::optional<std::pair<std::vector<T>, std::vector<std::vector<T>>>>
+lanczos(const Matrix<T> &A, int k, Spectrum which = Spectrum::largest, const double EPS = 1e-8, int basis = 0) {
+  return lanczos<T>(A.n, [&A](const T *x, T *y) { A.matvec(x, y); }, k, which, EPS, basis);
+}
+
+template<typename T>
+std::optional<std::pair<std::vector<T>, std::vector<std::vector<T>>>>
+lanczos(const SparseMatrix<T> &A, int k, Spectrum which = Spectrum::largest, const double EPS = 1e-8, int basis = 0) {
+  return lanczos<T>(A.n, [&A](const T *x, T *y) { A.matvec(x, y); }, k, which, EPS, basis);
+}
+
+}
+
+#endif//LINEAR_METHODS_LANCZOS_HPP_
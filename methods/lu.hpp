@@ -0,0 +1,267 @@
+//
+// Created by pospelov on 18.10.2026.
+//
+
+#ifndef LINEAR_METHODS_LU_HPP_
+#define LINEAR_METHODS_LU_HPP_
+
+#include "../core/gemm.hpp"
+#include "../core/matrix.hpp"
+#include "../core/report.hpp"
+#include "../core/thread_pool.hpp"
+#include "../core/util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+namespace Linear {
+
+/*
+ * P * A = L * U with L unit lower triangular below the diagonal of `lu` and U on and above it.
+ * Step i swapped rows i and pivots[i]; sign is the sign of the permutation.
+ * The factors are computed once and reused for any number of right-hand sides.
+ */
+template<typename T>
+struct LUFactorization {
+  Matrix<T> lu;
+  std::vector<int> pivots;
+  int sign;
+
+  explicit LUFactorization(const Matrix<T> &A) : lu(A), pivots(A.n), sign(1) {
+  }
+
+  int size() const {
+    return lu.n;
+  }
+
+  // x with A * x = b
+  std::vector<T> solve(const std::vector<T> &b) const {
+    const int n = lu.n;
+    if (b.size() != size_t(n)) {
+      throw std::runtime_error("Matrix and vector have incompatible dimensions!");
+    }
+    std::vector<T> x = b;
+    for (int i = 0; i < n; i++) {
+      std::swap(x[i], x[pivots[i]]);
+    }
+    for (int i = 0; i < n; i++) {
+      const T *l_i = lu.row_data(i);
+      T sum = x[i];
+      for (int j = 0; j < i; j++) {
+        sum -= l_i[j] * x[j];
+      }
+      x[i] = sum;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      const T *u_i = lu.row_data(i);
+      T sum = x[i];
+      for (int j = i + 1; j < n; j++) {
+        sum -= u_i[j] * x[j];
+      }
+      x[i] = sum / u_i[i];
+    }
+    return x;
+  }
+
+  // X with A * X = B; the columns of B are solved for in parallel strips.
+  Matrix<T> solve(const Matrix<T> &B) const {
+    const int n = lu.n;
+    if (B.n != n) {
+      throw std::runtime_error("Matrices have different sizes!");
+    }
+    Matrix<T> X = B;
+    for (int i = 0; i < n; i++) {
+      if (pivots[i] != i) {
+        std::swap_ranges(X.row_data(i), X.row_data(i) + n, X.row_data(pivots[i]));
+      }
+    }
+    parallel_for(0, n, (long long) n * n * n, [&](int lo, int hi) {
+      for (int i = 0; i < n; i++) {
+        const T *l_i = lu.row_data(i);
+        T *x_i = X.row_data(i) + lo;
+        for (int j = 0; j < i; j++) {
+          const T l = l_i[j];
+          const T *x_j = X.row_data(j) + lo;
+          for (int c = 0; c < hi - lo; c++) {
+            x_i[c] -= l * x_j[c];
+          }
+        }
+      }
+      for (int i = n - 1; i >= 0; i--) {
+        const T *u_i = lu.row_data(i);
+        T *x_i = X.row_data(i) + lo;
+        for (int j = i + 1; j < n; j++) {
+          const T u = u_i[j];
+          const T *x_j = X.row_data(j) + lo;
+          for (int c = 0; c < hi - lo; c++) {
+            x_i[c] -= u * x_j[c];
+          }
+        }
+        for (int c = 0; c < hi - lo; c++) {
+          x_i[c] /= u_i[i];
+        }
+      }
+    });
+    return X;
+  }
+
+  T determinant() const {
+    T det = sign;
+    for (int i = 0; i < lu.n; i++) {
+      det *= lu[i][i];
+    }
+    return det;
+  }
+
+  Matrix<T> inverse() const {
+    return solve(identity<T>(lu.n));
+  }
+};
+
+/*
+ * Right-looking blocked LU with partial pivoting. A panel of `block` columns is factored column by
+ * column (rows are swapped across the whole matrix), the block row of U right of it is solved with
+ * the panel's unit triangle, and the trailing matrix gets A22 -= L21 * U12 through GEMM.
+ * Throws if A is singular (a pivot column is exactly zero).
+ */
+template<typename T>
+LUFactorization<T> LU_blocked(const Matrix<T> &A, int block = 32) {
+  LUFactorization<T> F(A);
+  const int n = A.n;
+  block = std::max(block, 1);
+  Matrix<T> &a = F.lu;
+  for (int j0 = 0; j0 < n; j0 += block) {
+    const int j1 = std::min(n, j0 + block);
+    for (int j = j0; j < j1; j++) {
+      int p = j;
+      for (int i = j + 1; i < n; i++) {
+        if (std::abs(a[i][j]) > std::abs(a[p][j])) {
+          p = i;
+        }
+      }
+      if (a[p][j] == T(0)) {
+        throw std::runtime_error("Matrix is singular!");
+      }
+      F.pivots[j] = p;
+      if (p != j) {
+        std::swap_ranges(a.row_data(j), a.row_data(j) + n, a.row_data(p));
+        F.sign = -F.sign;
+      }
+      const T *a_j = a.row_data(j);
+      parallel_for(j + 1, n, (long long) (n - j) * (j1 - j), [&](int lo, int hi) {
+        for (int i = lo; i < hi; i++) {
+          T *a_i = a.row_data(i);
+          const T l = a_i[j] /= a_j[j];
+          for (int k = j + 1; k < j1; k++) {
+            a_i[k] -= l * a_j[k];
+          }
+        }
+      });
+    }
+    if (j1 == n) {
+      break;
+    }
+    // U12 = L11^-1 * A12
+    for (int i = j0 + 1; i < j1; i++) {
+      T *a_i = a.row_data(i);
+      for (int r = j0; r < i; r++) {
+        const T l = a_i[r];
+        const T *a_r = a.row_data(r);
+        for (int k = j1; k < n; k++) {
+          a_i[k] -= l * a_r[k];
+        }
+      }
+    }
+    gemm(n - j1, n - j1, j1 - j0, T(-1), a.row_data(j1) + j0, a.stride(), a.row_data(j0) + j1, a.stride(),
+         T(1), a.row_data(j1) + j1, a.stride());
+  }
+  return F;
+}
+
+/*
+ * A * x = b by iterative refinement in mixed precision (Langou et al., LAPACK dsgesv): A is factored
+ * in the lower precision Low (half the memory traffic, twice the SIMD width), the residual
+ * r = b - A * x is computed in T and the correction A * d = r is solved with the Low factors.
+ * Stops when |r| <= sqrt(n) * eps * |A| * |x| (infinity norms, eps of T). If a correction fails to
+ * halve the previous one, A is too ill-conditioned for Low and the system is solved by LU in T instead;
+ * so is it if the Low factorization breaks down. Throws if A is singular.
+ * The report counts the refinement steps; its reason is StopReason::fallback if the LU in T was taken.
+ */
+template<typename T, typename Low = float>
+std::vector<T> mixed_precision_solve(const Matrix<T> &A, const std::vector<T> &b, SolverReport *report = nullptr,
+                                     SolverObserver *observer = nullptr, int max_iters = 30) {
+  const int n = A.n;
+  if (b.size() != size_t(n)) {
+    throw std::runtime_error("Matrix and vector have incompatible dimensions!");
+  }
+  auto inf_norm = [](const std::vector<T> &v) {
+    T res = 0;
+    for (auto &x : v) {
+      res = std::max(res, std::abs(x));
+    }
+    return res;
+  };
+  T a_norm = 0;
+  for (int i = 0; i < n; i++) {
+    const T *a_i = A.row_data(i);
+    T sum = 0;
+    for (int j = 0; j < n; j++) {
+      sum += std::abs(a_i[j]);
+    }
+    a_norm = std::max(a_norm, sum);
+  }
+  const T tol = std::sqrt(T(n)) * std::numeric_limits<T>::epsilon() * a_norm;
+
+  Telemetry telemetry(report, observer);
+  auto fallback = [&](int iterations) {
+    auto x = LU_blocked(A).solve(b);
+    telemetry.stop(StopReason::fallback, iterations, abs(b - A * x));
+    return x;
+  };
+
+  std::optional<LUFactorization<Low>> F;
+  try {
+    F.emplace(LU_blocked(Matrix<Low>(A)));
+  } catch (std::runtime_error &) {// singular in Low, maybe not in T
+    return fallback(0);
+  }
+  auto low_solve = [&](const std::vector<T> &r) {
+    auto d = F->solve(std::vector<Low>(r.begin(), r.end()));
+    return std::vector<T>(d.begin(), d.end());
+  };
+
+  std::vector<T> x = low_solve(b), r(n);
+  T prev = std::numeric_limits<T>::infinity();
+  int iter = 0;
+  for (; iter <= max_iters; iter++) {
+    A.matvec(x.data(), r.data());
+    for (int i = 0; i < n; i++) {
+      r[i] = b[i] - r[i];
+    }
+    if (iter > 0) {
+      telemetry.step(iter, abs(r));
+    }
+    if (inf_norm(r) <= tol * inf_norm(x)) {
+      telemetry.stop(StopReason::converged, iter, abs(r));
+      return x;
+    }
+    if (iter == max_iters) {
+      break;
+    }
+    auto d = low_solve(r);
+    T d_norm = inf_norm(d);
+    if (!(d_norm <= prev / 2)) {
+      break;
+    }
+    prev = d_norm;
+    x += d;
+  }
+  return fallback(iter);
+}
+
+}
+
+#endif//LINEAR_METHODS_LU_HPP_
@@ -6,8 +6,12 @@
 #define LINEAR_METHODS_SEIDEL_HPP_
 
 #include "../core/matrix.hpp"
+#include "../core/report.hpp"
+#include "../core/thread_pool.hpp"
 #include "../core/util.hpp"
 
+#include <cmath>
+#include <numeric>
 #include <optional>
 #include <random>
 
@@ -16,38 +20,136 @@ namespace Linear {
 extern const int ITERS;
 extern const int LIMIT;
 
+// Pass as omega to let sor / ssor choose the relaxation factor themselves.
+const double AUTO_OMEGA = 0;
+
+// r_i = b_i - sum_j a_ij x_j
 template<typename T>
-std::pair<Matrix<T>, Matrix<T>> get_LU(const Matrix<T> &A) {
-  Matrix<T> L(A.n), U(A.n);
-  for (int i = 0; i < A.n; i++) {
-    for (int j = 0; j < A.n; j++) {
-      if (i >= j) {
-        L[i][j] = A[i][j];
-      } else {
-        U[i][j] = A[i][j];
+T row_residual(const Matrix<T> &A, const std::vector<T> &b, const std::vector<T> &x, int i) {
+  const T *a_i = A.row_data(i);
+  T r = b[i];
+  for (int j = 0; j < A.n; j++) {
+    r -= a_i[j] * x[j];
+  }
+  return r;
+}
+
+/*
+ * One in-place SOR sweep over the rows of A (backwards if `backward`):
+ * x_i += omega * r_i / a_ii with r_i = b_i - sum_j a_ij x_j taken over the latest x.
+ * omega = 1 is a Gauss-Seidel sweep. Returns |r|, the residual seen during the sweep.
+ */
+template<typename T>
+T sor_sweep(const Matrix<T> &A, const std::vector<T> &b, std::vector<T> &x, T omega, bool backward = false) {
+  const int n = A.n;
+  T sum = 0;
+  for (int k = 0; k < n; k++) {
+    const int i = (backward ? n - 1 - k : k);
+    T r = row_residual(A, b, x, i);
+    x[i] += omega * r / A[i][i];
+    sum += r * r;
+  }
+  return std::sqrt(sum);
+}
+
+/*
+ * Greedy coloring of the sparsity graph of A (i and j adjacent if a_ij or a_ji is nonzero):
+ * rows of one color do not depend on each other, so a Gauss-Seidel sweep may update them all at once.
+ * Returns the rows of every color.
+ */
+template<typename T>
+std::vector<std::vector<int>> greedy_coloring(const Matrix<T> &A) {
+  const int n = A.n;
+  std::vector<int> color(n, -1), used(n + 1, -1);
+  std::vector<std::vector<int>> classes;
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      if (color[j] >= 0 && j != i && (A[i][j] != 0 || A[j][i] != 0)) {
+        used[color[j]] = i;
       }
     }
+    int c = 0;
+    while (used[c] == i) {
+      c++;
+    }
+    color[i] = c;
+    if (c == int(classes.size())) {
+      classes.emplace_back();
+    }
+    classes[c].push_back(i);
   }
-  return {L, U};
+  return classes;
 }
 
+/*
+ * SOR sweep in multicolor order: colors one after another, the rows of a color in parallel.
+ * The residuals of a color are all taken before any of its rows is updated: the dense rows read
+ * every x_j, including the ones of their own color (with a_ij = 0), which must not change meanwhile.
+ * Returns the residual seen during the sweep, as sor_sweep.
+ */
 template<typename T>
-std::vector<T> solve_LU(const Matrix<T> &L, const Matrix<T> &U, const std::vector<T> &b, const std::vector<T> &prev_x) {
-  int n = L.n;
-  auto sum = -U * prev_x + b;
-  std::vector<T> new_x(n);
-  for (int i = 0; i < n; i++) {
-    new_x[i] = sum[i] / L[i][i];
-    for (int j = i + 1; j < n; j++) {
-      T k = L[j][i] / L[i][i];
-      sum[j] -= sum[i] * k;
+T multicolor_sweep(const Matrix<T> &A, const std::vector<T> &b, std::vector<T> &x, T omega,
+                   const std::vector<std::vector<int>> &classes) {
+  std::vector<T> r(A.n);
+  for (const auto &rows : classes) {
+    parallel_for(0, rows.size(), (long long) rows.size() * A.n, [&](int lo, int hi) {
+      for (int k = lo; k < hi; k++) {
+        r[rows[k]] = row_residual(A, b, x, rows[k]);
+      }
+    });
+    for (int i : rows) {
+      x[i] += omega * r[i] / A[i][i];
     }
   }
-  return new_x;
+  return std::sqrt(std::inner_product(r.begin(), r.end(), r.begin(), T(0)));
 }
 
+/*
+ * Weighted Jacobi sweep: x_i += omega * r_i / a_ii with every r_i taken over the old x, rows in parallel.
+ * Returns |r| of the old x.
+ */
 template<typename T>
-std::optional<std::vector<T>> seidel(const Matrix<T> &A, const std::vector<T> &b, const double EPS = 1e-3) {
+T jacobi_sweep(const Matrix<T> &A, const std::vector<T> &b, std::vector<T> &x, T omega) {
+  std::vector<T> r(A.n);
+  parallel_for(0, A.n, (long long) A.n * A.n, [&](int lo, int hi) {
+    for (int i = lo; i < hi; i++) {
+      r[i] = row_residual(A, b, x, i);
+    }
+  });
+  T sum = 0;
+  for (int i = 0; i < A.n; i++) {
+    x[i] += omega * r[i] / A[i][i];
+    sum += r[i] * r[i];
+  }
+  return std::sqrt(sum);
+}
+
+/*
+ * Relaxation factor from mu2, the squared spectral radius of the Jacobi iteration:
+ * Young's omega = 2 / (1 + sqrt(1 - mu^2)) for SOR, exact for consistently ordered matrices,
+ * and 2 / (1 + sqrt(2 * (1 - mu))) for SSOR.
+ */
+template<typename T>
+T optimal_omega(T mu2, bool symmetric) {
+  mu2 = std::min(std::max(mu2, T(0)), T(0.9999));
+  return (symmetric ? 2 / (1 + std::sqrt(2 * (1 - std::sqrt(mu2)))) : 2 / (1 + std::sqrt(1 - mu2)));
+}
+
+/*
+ * Stationary iteration for A * x = b, sweep(x, omega) doing one iteration in place and returning
+ * the residual it saw: SOR, SSOR (symmetric: a forward and a backward sweep), multicolor SOR or Jacobi.
+ * The residual of the sweep serves as the stopping check and is confirmed with |A * x - b| < EPS
+ * before returning.
+ * With omega = AUTO_OMEGA the iteration starts as Gauss-Seidel and adapts omega (Hageman, Young):
+ * once the contraction rate lambda of the sweep residuals has settled, mu^2 is estimated from
+ * (lambda + omega - 1)^2 = lambda * omega^2 * mu^2 and omega is raised to optimal_omega(mu^2).
+ * Above the optimum the rate is omega - 1 and tells nothing new, so omega is never lowered.
+ * Like simple_iteration, gives up when |x| has grown for ITERS iterations in a row.
+ * An observer sees the residual of every sweep.
+ */
+template<typename T, typename Sweep>
+std::optional<std::vector<T>> relaxation(const Matrix<T> &A, const std::vector<T> &b, double omega, bool symmetric,
+                                         const double EPS, SolverReport *report, SolverObserver *observer, Sweep &&sweep) {
   int n = A.n;
 
   if (!check_dimension(A, b)) {
@@ -60,13 +162,36 @@ std::optional<std::vector<T>> seidel(const Matrix<T> &A, const std::vector<T> &b
     }
   }
 
-  auto [L, U] = get_LU(A);
-  auto x = random_vector<T>(n);
+  const bool adaptive = (omega == AUTO_OMEGA);
+  T w = (adaptive ? T(1) : T(omega));
+  T prev_rate = 0, prev_res = 0;
+  int stable = 0;
 
+  auto x = random_vector<T>(n);
+  Telemetry telemetry(report, observer);
   int increase = 0;
   long double prv_abs = abs(x);
-  for (int iter = 0; iter < LIMIT; iter++) {
-    x = solve_LU(L, U, b, x);
+  int iter = 0;
+  StopReason reason = StopReason::iteration_limit;
+  while (iter < LIMIT) {
+    iter++;
+    T res = sweep(x, w);
+    telemetry.step(iter, res);
+    if (adaptive && prev_res > 0) {
+      T rate = res / prev_res;
+      stable = (std::abs(rate - prev_rate) < T(0.001) * rate ? stable + 1 : 0);
+      prev_rate = rate;
+      if (stable >= 3 && rate < 1 && rate > w - 1) {
+        T mu2 = (rate + w - 1) * (rate + w - 1) / (rate * w * w);
+        T next = optimal_omega(mu2, symmetric);
+        if (next > w * T(1.001) && (!symmetric || w == 1)) {
+          w = next;
+          stable = 0;
+        }
+      }
+    }
+    prev_res = res;
+
     long double cur_abs = abs(x);
     if (cur_abs >= prv_abs + 1) {
       increase++;
@@ -75,16 +200,65 @@ std::optional<std::vector<T>> seidel(const Matrix<T> &A, const std::vector<T> &b
     }
     prv_abs = cur_abs;
 
-    if (abs(A * x - b) < EPS) {
-      return std::optional(x);
+    if (res < EPS) {
+      auto r = A * x - b;
+      if (abs(r) < EPS) {
+        telemetry.stop(StopReason::converged, iter, abs(r));
+        return std::optional(x);
+      }
     }
     if (increase >= ITERS) {
-      return std::nullopt;
+      reason = StopReason::diverged;
+      break;
     }
   }
+  if (report || observer) {
+    telemetry.stop(reason, iter, abs(A * x - b));
+  }
   return std::nullopt;
 }
 
+template<typename T>
+std::optional<std::vector<T>> sor(const Matrix<T> &A, const std::vector<T> &b, double omega = AUTO_OMEGA,
+                                  const double EPS = 1e-3, SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  return relaxation(A, b, omega, false, EPS, report, observer, [&](std::vector<T> &x, T w) { return sor_sweep(A, b, x, w); });
+}
+
+template<typename T>
+std::optional<std::vector<T>> ssor(const Matrix<T> &A, const std::vector<T> &b, double omega = AUTO_OMEGA,
+                                   const double EPS = 1e-3, SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  return relaxation(A, b, omega, true, EPS, report, observer, [&](std::vector<T> &x, T w) {
+    sor_sweep(A, b, x, w);
+    return sor_sweep(A, b, x, w, true);
+  });
+}
+
+template<typename T>
+std::optional<std::vector<T>> seidel(const Matrix<T> &A, const std::vector<T> &b, const double EPS = 1e-3,
+                                     SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  return sor(A, b, 1, EPS, report, observer);
+}
+
+/*
+ * SOR in the order of a greedy coloring of A, every color updated in parallel. Converges like SOR
+ * with rows reordered by color (for the 5-point stencil this is the red-black ordering).
+ */
+template<typename T>
+std::optional<std::vector<T>> multicolor_sor(const Matrix<T> &A, const std::vector<T> &b, double omega = AUTO_OMEGA,
+                                             const double EPS = 1e-3, SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  const auto classes = greedy_coloring(A);
+  return relaxation(A, b, omega, false, EPS, report, observer,
+                    [&](std::vector<T> &x, T w) { return multicolor_sweep(A, b, x, w, classes); });
+}
+
+// Weighted Jacobi, rows in parallel; omega is fixed (AUTO_OMEGA means 1).
+template<typename T>
+std::optional<std::vector<T>> jacobi(const Matrix<T> &A, const std::vector<T> &b, double omega = 1,
+                                     const double EPS = 1e-3, SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
+  omega = (omega == AUTO_OMEGA ? 1 : omega);
+  return relaxation(A, b, omega, false, EPS, report, observer, [&](std::vector<T> &x, T w) { return jacobi_sweep(A, b, x, w); });
+}
+
 }
 
 #endif//LINEAR_METHODS_SEIDEL_HPP_
@@ -6,6 +6,7 @@
 #define LINEAR_METHODS_SIMPLE_ITERATION_HPP_
 
 #include "../core/matrix.hpp"
+#include "../core/report.hpp"
 #include "../core/util.hpp"
 
 #include <optional>
@@ -16,8 +17,15 @@ namespace Linear {
 const int ITERS = 20;
 const int LIMIT = 1000;
 
-template<class T>
-std::optional<std::vector<T>> simple_iteration(const Matrix<T> &A, const std::vector<T> &b, const double EPS = 1e-3) {
+/*
+ * x = A * x + b until |x - A * x - b| < EPS. A is any matrix with n, operator*(std::vector) and
+ * gershgorin_circles: a Matrix<T, N> or an out-of-core TiledMatrix<T>. Every iteration costs one
+ * product, the residual of x being the step to the next iterate. Stops as diverged when |x| has grown
+ * for ITERS iterations in a row and the Gershgorin circles do not prove convergence.
+ */
+template<class M, class T = typename M::value_type>
+std::optional<std::vector<T>> simple_iteration(const M &A, const std::vector<T> &b, const double EPS = 1e-3,
+                                               SolverReport *report = nullptr, SolverObserver *observer = nullptr) {
   int n = A.n;
   if (!check_dimension(A, b)) {
     throw std::runtime_error("Bad arguments!");
@@ -33,10 +41,19 @@ std::optional<std::vector<T>> simple_iteration(const Matrix<T> &A, const std::ve
 
   auto x = random_vector<T>(n);
 
+  Telemetry telemetry(report, observer);
   int increase = 0;
   long double prv_abs = abs(x);
-  for (int iter = 0; iter < LIMIT; iter++) {
-    x = A * x + b;
+  T res = 0;
+  for (int iter = 1; iter <= LIMIT; iter++) {
+    std::vector<T> next = A * x + b;
+    res = abs(x - next);
+    telemetry.step(iter, res);
+    if (res < EPS) {
+      telemetry.stop(StopReason::converged, iter, res);
+      return std::optional(x);
+    }
+    x = std::move(next);
     long double cur_abs = abs(x);
     if (cur_abs >= prv_abs + 1) {
       increase++;
@@ -45,13 +62,12 @@ std::optional<std::vector<T>> simple_iteration(const Matrix<T> &A, const std::ve
     }
     prv_abs = cur_abs;
 
-    if (abs(x - A * x - b) < EPS) {
-      return std::optional(x);
-    }
     if (increase >= ITERS && bad_circles) {
+      telemetry.stop(StopReason::diverged, iter, res);
       return std::nullopt;
     }
   }
+  telemetry.stop(StopReason::iteration_limit, LIMIT, res);
   return std::nullopt;
 }
 
@@ -5,82 +5,344 @@
 #ifndef LINEAR_METHODS_TRIDIAGONALIZATION_HPP_
 #define LINEAR_METHODS_TRIDIAGONALIZATION_HPP_
 
+#include "../core/gemm.hpp"
+#include "../core/sym_tridiagonal.hpp"
+#include "../core/thread_pool.hpp"
 #include "../core/util.hpp"
 #include "givens.hpp"
 #include "householder.hpp"
 
+#include <mutex>
+
 namespace Linear {
 
+/*
+ * y[from..n) = S * v[from..n) for the trailing block S = A[from.., from..] of a symmetric matrix
+ * of which only the upper triangle (row r, columns >= r) is read. Each row is read once and
+ * used for both its own entry of y and, as the column below the diagonal, for the entries after it;
+ * chunks of rows accumulate into private vectors that are summed at the end.
+ */
 template<typename T>
-std::pair<Matrix<T>, Matrix<T>> tridiagonalization(const Matrix<T> &A) {
+void symv_upper(const Matrix<T> &A, int from, const T *v, T *y) {
+  const int n = A.n, m = n - from;
+  std::fill(y + from, y + n, T(0));
+  std::mutex mutex;
+  parallel_for(from, n, (long long) m * m, [&](int lo, int hi) {
+    std::vector<T> part(n - lo);// part[c - lo]
+    for (int r = lo; r < hi; r++) {
+      const T *a_r = A.row_data(r);
+      const T v_r = v[r];
+      T *p = part.data() - lo;
+      // the row sum is kept in LANES independent partial sums so that the loop vectorizes
+      const int LANES = 8;
+      T sums[LANES] = {};
+      int c = r + 1;
+      for (; c + LANES <= n; c += LANES) {
+        for (int l = 0; l < LANES; l++) {
+          sums[l] += a_r[c + l] * v[c + l];
+          p[c + l] += a_r[c + l] * v_r;
+        }
+      }
+      T sum = a_r[r] * v_r;
+      for (; c < n; c++) {
+        sum += a_r[c] * v[c];
+        p[c] += a_r[c] * v_r;
+      }
+      for (int l = 0; l < LANES; l++) {
+        sum += sums[l];
+      }
+      p[r] += sum;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int c = lo; c < n; c++) {
+      y[c] += part[c - lo];
+    }
+  });
+}
+
+/*
+ * Q^T * A * Q = T for a symmetric A: T tridiagonal, Q = H_0 * H_1 * ... * H_{n-2}.
+ * Reflector H_i = I - tau[i] * v * v^T acts on rows i + 1.. with v = (1, a[i][i + 2], ..., a[i][n - 1]),
+ * i.e. the reflectors are kept in the rows of `a` right of the subdiagonal.
+ */
+template<typename T>
+struct TridiagonalReduction {
+  Matrix<T> a;
+  std::vector<T> tau;
+  std::vector<T> d, e;
+  int block;
+
+  TridiagonalReduction(const Matrix<T> &A, int block)
+      : a(A), tau(std::max(A.n - 1, 0)), d(A.n), e(std::max(A.n - 1, 0)), block(std::max(block, 1)) {
+  }
+
+  int size() const {
+    return a.n;
+  }
+
+  SymTridiagonal<T> tridiagonal() const {
+    return SymTridiagonal<T>(d, e);
+  }
+
+  Matrix<T> Q() const {
+    Matrix<T> res = identity<T>(a.n);
+    apply_q(res);
+    return res;
+  }
+
+  // C := Q^T * C
+  void apply_qt(Matrix<T> &C) const {
+    for (int j0 = 0; j0 < int(tau.size()); j0 += block) {
+      apply_panel(C, j0, true);
+    }
+  }
+
+  // C := Q * C
+  void apply_q(Matrix<T> &C) const {
+    if (tau.empty()) {
+      return;
+    }
+    for (int j0 = (int(tau.size()) - 1) / block * block; j0 >= 0; j0 -= block) {
+      apply_panel(C, j0, false);
+    }
+  }
+
+  // x := Q^T * x
+  void apply_qt(std::vector<T> &x) const {
+    for (int j = 0; j < int(tau.size()); j++) {
+      apply_reflector(x, j);
+    }
+  }
+
+  // x := Q * x
+  void apply_q(std::vector<T> &x) const {
+    for (int j = int(tau.size()) - 1; j >= 0; j--) {
+      apply_reflector(x, j);
+    }
+  }
+
+  // Reflectors j0..j0 + jb - 1 on rows j0 + 1.. as a unit lower trapezoidal (n - j0 - 1) x jb matrix.
+  std::vector<T> panel(int j0, int jb) const {
+    int m = a.n - j0 - 1;
+    std::vector<T> V(size_t(m) * jb);
+    for (int r = 0; r < m; r++) {
+      for (int j = 0; j < jb && j <= r; j++) {
+        V[size_t(r) * jb + j] = (r == j ? T(1) : a[j0 + j][j0 + 1 + r]);
+      }
+    }
+    return V;
+  }
+
+ private:
+  void apply_panel(Matrix<T> &C, int j0, bool transpose) const {
+    if (C.n != a.n) {
+      throw std::runtime_error("Matrices have different sizes!");
+    }
+    int jb = std::min(block, int(tau.size()) - j0), m = a.n - j0 - 1;
+    auto V = panel(j0, jb);
+    auto Tf = block_reflector_factor(m, jb, V.data(), tau.data() + j0);
+    apply_block_reflector(m, C.n, jb, V.data(), Tf.data(), C.row_data(j0 + 1), C.stride(), transpose);
+  }
+
+  void apply_reflector(std::vector<T> &x, int j) const {
+    if (x.size() != a.n) {
+      throw std::runtime_error("Matrix and vector have incompatible dimensions!");
+    }
+    if (tau[j] == 0) {
+      return;
+    }
+    const T *v = a.row_data(j);
+    T w = x[j + 1];
+    for (int i = j + 2; i < a.n; i++) {
+      w += v[i] * x[i];
+    }
+    w *= tau[j];
+    x[j + 1] -= w;
+    for (int i = j + 2; i < a.n; i++) {
+      x[i] -= w * v[i];
+    }
+  }
+};
+
+/*
+ * Blocked Householder tridiagonalization of a symmetric matrix (LAPACK's sytrd/latrd), reading and
+ * updating only the upper triangle, whose row i is the column i of the lower one.
+ * Within a panel of `block` columns the trailing matrix is not touched: column i is brought up to date
+ * from the panel's V and W, and W collects tau * (A - V * W^T - W * V^T) * v. The trailing matrix then
+ * gets the symmetric rank-2k update A -= V * W^T + W * V^T, done with GEMM over row blocks of the
+ * upper triangle.
+ */
+template<typename T>
+TridiagonalReduction<T> tridiagonal_reduction(const Matrix<T> &A, int block = 32) {
   if (!is_symmetric(A)) {
     throw std::runtime_error("Matrix is not symmetric!");
   }
-  int n = A.n;
-  Matrix<T> A0 = A;
-  Matrix<T> Q = identity(n);
-  for (int c = 0; c < n; c++) {
-    std::vector<T> v(n);
-    for (int i = c + 1; i < n; i++) {
-      v[i] = A0[i][c];
-    }
-    if (is_zero(v)) {
-      continue;
+  TridiagonalReduction<T> F(A, block);
+  const int n = A.n;
+  Matrix<T> &a = F.a;
+  for (int i0 = 0; i0 < n; i0 += F.block) {
+    const int nb = std::min(F.block, n - i0), i1 = i0 + nb;
+    // k-th vectors of the panel, stored by rows: Vt[k * n + r] = V(r, k)
+    std::vector<T> Vt(size_t(nb) * n), Wt(size_t(nb) * n), y(n), h(2 * nb);
+    for (int i = i0; i < i1; i++) {
+      const int k = i - i0;
+      T *a_i = a.row_data(i);
+      for (int p = 0; p < k; p++) {
+        const T *v_p = Vt.data() + size_t(p) * n, *w_p = Wt.data() + size_t(p) * n;
+        const T wi = w_p[i], vi = v_p[i];
+        for (int r = i; r < n; r++) {
+          a_i[r] -= v_p[r] * wi + w_p[r] * vi;
+        }
+      }
+      F.d[i] = a_i[i];
+      if (i + 1 == n) {
+        break;
+      }
+
+      const T tau = F.tau[i] = make_reflector(n - i - 1, a_i + i + 1, 1);
+      F.e[i] = a_i[i + 1];
+      T *v = Vt.data() + size_t(k) * n, *w = Wt.data() + size_t(k) * n;
+      v[i + 1] = 1;
+      std::copy(a_i + i + 2, a_i + n, v + i + 2);
+      if (tau == 0) {
+        continue;
+      }
+
+      // w = tau * (A22 - V * W^T - W * V^T) * v, then w -= tau / 2 * (w^T v) * v
+      symv_upper(a, i + 1, v, w);
+      for (int p = 0; p < k; p++) {
+        const T *v_p = Vt.data() + size_t(p) * n, *w_p = Wt.data() + size_t(p) * n;
+        T sw = 0, sv = 0;
+        for (int r = i + 1; r < n; r++) {
+          sw += w_p[r] * v[r];
+          sv += v_p[r] * v[r];
+        }
+        h[2 * p] = sw;
+        h[2 * p + 1] = sv;
+      }
+      for (int p = 0; p < k; p++) {
+        const T *v_p = Vt.data() + size_t(p) * n, *w_p = Wt.data() + size_t(p) * n;
+        for (int r = i + 1; r < n; r++) {
+          w[r] -= v_p[r] * h[2 * p] + w_p[r] * h[2 * p + 1];
+        }
+      }
+      T dot = 0;
+      for (int r = i + 1; r < n; r++) {
+        w[r] *= tau;
+        dot += w[r] * v[r];
+      }
+      const T alpha = -tau / 2 * dot;
+      for (int r = i + 1; r < n; r++) {
+        w[r] += alpha * v[r];
+      }
+    }
+    if (i1 >= n) {
+      break;
     }
 
-    HouseholderMatrix H(v, c + 1);
-    A0 = (H * (H * A0).transpose()).transpose();
-    Q = H * Q;
+    /*
+     * rows r of the trailing upper triangle: a[r][c] -= W(r, :) * V(c, :)^T + V(r, :) * W(c, :)^T, c >= r,
+     * i.e. a single rank-2nb product [W V](r, :) * [V W](c, :)^T. It runs as one gemm per block of rows,
+     * issued one after another from here so that each gemm parallelizes on its own.
+     */
+    const int k2 = 2 * nb;
+    std::vector<T> WV(size_t(n) * k2), VWt(size_t(k2) * n);
+    for (int r = i1; r < n; r++) {
+      for (int k = 0; k < nb; k++) {
+        WV[size_t(r) * k2 + k] = Wt[size_t(k) * n + r];
+        WV[size_t(r) * k2 + nb + k] = Vt[size_t(k) * n + r];
+      }
+    }
+    std::copy(Vt.begin(), Vt.end(), VWt.begin());
+    std::copy(Wt.begin(), Wt.end(), VWt.begin() + size_t(nb) * n);
+    const int ROWS = 128;
+    for (int r0 = i1; r0 < n; r0 += ROWS) {
+      const int mb = std::min(ROWS, n - r0), nc = n - r0;
+      gemm(mb, nc, k2, T(-1), WV.data() + size_t(r0) * k2, k2, VWt.data() + r0, n, T(1),
+           a.row_data(r0) + r0, a.stride());
+    }
   }
-  return {A0, Q.transpose()};
+  return F;
 }
 
+/*
+ * A = Q * A' * Q^T with A' tridiagonal; returns {A', Q}.
+ */
 template<typename T>
-std::pair<Matrix<T>, Matrix<T>> QR_givens_tridiagonalization(const Matrix<T> &A, int Mx = -1) { // A should be tridiagonalized
-  int n = A.n;
+std::pair<Matrix<T>, Matrix<T>> tridiagonalization(const Matrix<T> &A) {
+  auto F = tridiagonal_reduction(A);
+  return {F.tridiagonal().to_matrix(), F.Q()};
+}
+
+// QR_givens_in_place for a tridiagonal R: O(n) rotations touching O(1) entries each.
+template<typename T>
+void QR_givens_tridiagonalization_in_place(Matrix<T> &R, GivensSequence<T> &Q, int Mx = -1) {
+  int n = R.n;
+  if (Q.n != n) {
+    throw std::runtime_error("Matrices have different sizes!");
+  }
   Mx = (Mx == -1 ? n : Mx);
-  Matrix<T> A0 = A;
-  Matrix<T> Q = identity(n);
+  Q.clear();
   for (int c = 0; c < Mx; c++) {
     int r = c;
-    while (r < std::min(c + 1, Mx) && is_zero(A0[r][c])) {
+    while (r < std::min(c + 1, Mx) && is_zero(R[r][c])) {
       r++;
     }
     if (r == Mx) {
       continue;
     }
+    const int to = std::min(n, c + 3);// rows c and c + 1 have no entries right of c + 2
     for (int i = r + 1; i < std::min(Mx, c + 2); i++) {
-      GivensMatrix G(i, r, A0[i][c], A0[r][c]);
-      A0 = G * A0;
-      Q = G * Q;
+      GivensMatrix G(i, r, R[i][c], R[r][c]);
+      rotate_rows(R, G, c, to);
+      R[i][c] = 0;
+      Q.push(G);
     }
     GivensMatrix G(r, c, 1, 0);
-    A0 = G * A0;
-    Q = G * Q;
+    rotate_rows(R, G, c, to);
+    Q.push(G);
   }
-  return {Q.transpose(), A0};
 }
 
 template<typename T>
-std::optional<std::pair<std::vector<T>, Matrix<T>>> eigen_qr_tridiagonalization(const Matrix<T> &A, const double EPS = 1e-3) {
+std::pair<GivensSequence<T>, Matrix<T>> QR_givens_tridiagonalization(const Matrix<T> &A, int Mx = -1) { // A should be tridiagonalized
+  Matrix<T> R = A;
+  GivensSequence<T> Q(A.n);
+  QR_givens_tridiagonalization_in_place(R, Q, Mx);
+  return {std::move(Q), std::move(R)};
+}
+
+/*
+ * Unshifted QR iteration on a tridiagonal A. As in eigen_qr, the iterate and the rotations are reused
+ * from step to step and come from the workspace if one is given.
+ */
+template<typename T>
+std::optional<std::pair<std::vector<T>, Matrix<T>>> eigen_qr_tridiagonalization(const Matrix<T> &A, const double EPS = 1e-3,
+                                                                                Workspace *workspace = nullptr) {
   int n = A.n;
-  Matrix<T> Q = identity(n);
-  auto cur_A = A;
+  Matrix<T> Q = identity<T>(n);
+  Matrix<T> cur_A = scratch_copy(workspace, A);
+  GivensSequence<T> Q_new(n, workspace);
   for (int i = 0; i < LIMIT; i++) {
-    auto [Q_new, R_new] = QR_givens_tridiagonalization(cur_A); // O(n^2)
-    cur_A = R_new * Q_new;
+    QR_givens_tridiagonalization_in_place(cur_A, Q_new); // O(n)
+    cur_A *= Q_new;
     Q *= Q_new;
-    std::vector<std::pair<T, long double>> circles = gershgorin_circles(cur_A); // O(n^2)
-    long double rad = 0;
-    for (auto &i : circles) {
-      rad = std::max(rad, i.second);
+    long double rad = 0; // the largest Gershgorin radius, O(n^2)
+    for (int r = 0; r < n; r++) {
+      long double radius = 0;
+      for (int c = 0; c < n; c++) {
+        if (r != c) {
+          radius += std::abs(cur_A[r][c]);
+        }
+      }
+      rad = std::max(rad, radius);
     }
     if (rad < EPS) {
       std::vector<T> lambdas(n);
       for (auto i = 0; i < n; i++) {
-        lambdas[i] = circles[i].first;
+        lambdas[i] = cur_A[i][i];
       }
-      return std::optional(make_pair(lambdas, Q));
+      return std::optional(make_pair(std::move(lambdas), std::move(Q)));
     }
   }
   return std::nullopt;
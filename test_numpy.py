@@ -1,9 +1,43 @@
+import struct
+
+import numpy as np
 from numpy import linalg as LA
-FILE = open("cmake-build-debug/matrix", "r")
-text = FILE.read()
-G = list(map(lambda x: list(map(int, x.strip().split(' '))), text.strip().split('\n')))
 
-eigen_values = sorted(LA.eig(G)[0])
-print(eigen_values)
+# Reads a matrix written by Linear::save_matrix (see core/matrix_file.hpp): a 64-byte header and
+# a 64-byte aligned payload, mapped with np.memmap instead of being parsed.
+PATH = "cmake-build-debug/matrix"
+DTYPES = {1: np.float32, 2: np.float64}
+
+
+def align(offset):
+    return (offset + 63) // 64 * 64
 
 
+def load_matrix(path):
+    with open(path, "rb") as f:
+        header = f.read(64)
+    magic, version, dtype, layout, _, rows, cols, ld, nnz, offset = struct.unpack("<8s4I5Q", header)
+    if magic != b"LINMATRX" or version != 1:
+        raise ValueError("not a matrix file")
+    dtype = DTYPES[dtype]
+    if layout == 0:
+        return np.memmap(path, dtype=dtype, mode="r", offset=offset, shape=(rows, ld))[:, :cols]
+    if layout == 2:
+        # ld x ld tiles in row-major tile order, edge tiles padded
+        side = (rows + ld - 1) // ld
+        tiles = np.memmap(path, dtype=dtype, mode="r", offset=offset, shape=(side, side, ld, ld))
+        return tiles.transpose(0, 2, 1, 3).reshape(side * ld, side * ld)[:rows, :cols]
+    if layout != 1:
+        raise ValueError("unknown matrix layout %d" % layout)
+    row_ptr = np.memmap(path, dtype=np.int32, mode="r", offset=offset, shape=(rows + 1,))
+    col_offset = align(offset + 4 * (rows + 1))
+    col = np.memmap(path, dtype=np.int32, mode="r", offset=col_offset, shape=(nnz,))
+    val = np.memmap(path, dtype=dtype, mode="r", offset=align(col_offset + 4 * nnz), shape=(nnz,))
+    G = np.zeros((rows, cols), dtype=dtype)
+    G[np.repeat(np.arange(rows), np.diff(row_ptr)), col] = val
+    return G
+
+
+G = load_matrix(PATH)
+eigen_values = sorted(LA.eig(G)[0])
+print(eigen_values)